@@ -0,0 +1,37 @@
+#include <cstdio>
+#include <string>
+
+#include "src/benchmark.h"
+
+using namespace CppUtils;
+
+// Usage: cpputils-bench [--format=table|json|csv] [group filter]
+int main(int argc, char* argv[]) {
+  auto format = Bench::Format::Table;
+  auto filter = std::string();
+
+  for (auto i = 1; i < argc; i++) {
+    auto argument = std::string(argv[i]);
+    if (argument == "--format=json") {
+      format = Bench::Format::Json;
+    } else if (argument == "--format=csv") {
+      format = Bench::Format::Csv;
+    } else if (argument == "--format=table") {
+      format = Bench::Format::Table;
+    } else if (argument.rfind("--", 0) == 0) {
+      std::fprintf(stderr,
+                   "usage: %s [--format=table|json|csv] [group filter]\n",
+                   argv[0]);
+      return 1;
+    } else {
+      filter = argument;
+    }
+  }
+
+  Bench::Start(format);
+  Bench::Run("executor", filter, Bench::ExecutorBenchmarks);
+  Bench::Run("parallel", filter, Bench::ParallelBenchmarks);
+  Bench::Run("synchronization", filter, Bench::SynchronizationBenchmarks);
+  Bench::Finish();
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include "benchmark.h"
+
+#include <cstdio>
+#include <thread>
+
+namespace CppUtils {
+namespace Bench {
+namespace {
+struct Result {
+  std::string group;
+  std::string name;
+  std::size_t size;
+  double nanos;
+  double speedup;
+};
+
+Format format = Format::Table;
+std::string group;
+std::vector<Result> results;
+
+void writeJson() {
+  std::printf("{\n  \"hardware_concurrency\": %u,\n  \"results\": [",
+              std::thread::hardware_concurrency());
+
+  for (auto i = std::size_t(0); i < results.size(); i++) {
+    auto& result = results[i];
+    std::printf(
+        "%s\n    {\"group\": \"%s\", \"name\": \"%s\", \"size\": %zu, "
+        "\"ns\": %.1f, \"speedup\": ",
+        i == 0 ? "" : ",", result.group.c_str(), result.name.c_str(),
+        result.size, result.nanos);
+    if (result.speedup > 0.0) {
+      std::printf("%.3f}", result.speedup);
+    } else {
+      std::printf("null}");
+    }
+  }
+  std::printf("\n  ]\n}\n");
+}
+
+void writeCsv() {
+  std::printf("group,name,size,ns,speedup\n");
+  for (auto& result : results) {
+    std::printf("%s,%s,%zu,%.1f,", result.group.c_str(), result.name.c_str(),
+                result.size, result.nanos);
+    if (result.speedup > 0.0) {
+      std::printf("%.3f", result.speedup);
+    }
+    std::printf("\n");
+  }
+}
+}  // namespace
+
+void Report(const std::string& name, std::size_t size, double nanos,
+            double baseline) {
+  auto speedup = baseline > 0.0 && nanos > 0.0 ? baseline / nanos : 0.0;
+  results.push_back({group, name, size, nanos, speedup});
+
+  if (format != Format::Table) {
+    return;
+  }
+  if (speedup > 0.0) {
+    std::printf("%-32s %12zu %14.0f ns %8.2fx\n", name.c_str(), size, nanos,
+                speedup);
+  } else {
+    std::printf("%-32s %12zu %14.0f ns %9s\n", name.c_str(), size, nanos,
+                "-");
+  }
+  std::fflush(stdout);
+}
+
+// Not static, so the compiler cannot prove the stores are never read.
+const void* volatile escaped = nullptr;
+
+void Escape(const void* pointer) { escaped = pointer; }
+
+void Run(const std::string& name, const std::string& filter,
+         void (*benchmarks)()) {
+  if (name.find(filter) == std::string::npos) {
+    return;
+  }
+
+  group = name;
+  if (format == Format::Table) {
+    std::printf("%-32s %12s %17s %9s\n", name.c_str(), "size", "median",
+                "speedup");
+  }
+  benchmarks();
+  if (format == Format::Table) {
+    std::printf("\n");
+  }
+}
+
+void Start(Format output) {
+  format = output;
+  results.clear();
+}
+
+void Finish() {
+  if (format == Format::Json) {
+    writeJson();
+  } else if (format == Format::Csv) {
+    writeCsv();
+  }
+}
+}  // namespace Bench
+}  // namespace CppUtils
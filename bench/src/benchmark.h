@@ -0,0 +1,67 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace CppUtils {
+namespace Bench {
+// Table is for reading; Json and Csv hold the same rows for comparing runs
+// between releases.
+enum class Format { Table, Json, Csv };
+
+// Median wall time of one call of function in nanoseconds. setup runs
+// before every call and is not timed.
+template <typename Setup, typename F>
+double Measure(std::size_t repetitions, Setup&& setup, F&& function) {
+  std::vector<double> times;
+  for (auto i = std::size_t(0); i < std::max(repetitions, std::size_t(1));
+       i++) {
+    setup();
+
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    times.emplace_back(
+        std::chrono::duration<double, std::nano>(elapsed).count());
+  }
+
+  std::nth_element(times.begin(), times.begin() + times.size() / 2,
+                   times.end());
+  return times[times.size() / 2];
+}
+
+template <typename F>
+double Measure(std::size_t repetitions, F&& function) {
+  return Measure(repetitions, [] {}, function);
+}
+
+// Records one row of the running group: nanos per operation at the given
+// size, and the speedup over baseline unless baseline is zero. Table rows
+// are printed right away, the others by Finish().
+void Report(const std::string& name, std::size_t size, double nanos,
+            double baseline = 0.0);
+
+// Runs the benchmark group if its name contains filter.
+void Run(const std::string& group, const std::string& filter,
+         void (*benchmarks)());
+
+void Start(Format format);
+void Finish();
+
+// Keeps the optimizer from discarding a result: the address escapes into
+// another translation unit.
+void Escape(const void* pointer);
+
+template <typename T>
+void Consume(const T& value) {
+  Escape(&value);
+}
+
+void ParallelBenchmarks();
+void ExecutorBenchmarks();
+void SynchronizationBenchmarks();
+}  // namespace Bench
+}  // namespace CppUtils
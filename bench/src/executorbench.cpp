@@ -0,0 +1,194 @@
+#include <cpputils/countdownlatch.h>
+#include <cpputils/threadpertaskexecutor.h>
+#include <cpputils/threadpoolexecutor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const std::size_t REPETITIONS = 7;
+
+// Every executor benchmark runs against a fresh executor, so one run's
+// leftover threads or queued tasks cannot skew the next.
+struct Subject {
+  std::string name;
+  std::function<std::unique_ptr<Executor>()> create;
+
+  // Tasks per measured batch; starting a thread per task is orders of
+  // magnitude slower than queueing one.
+  std::size_t tasks;
+};
+
+void WaitFor(const std::atomic<std::size_t>& counter, std::size_t target) {
+  while (counter.load(std::memory_order_acquire) < target) {
+    std::this_thread::yield();
+  }
+}
+
+// Time of the Execute call alone; the tasks are drained untimed.
+void SubmitLatency(const Subject& subject) {
+  auto executor = subject.create();
+  auto done = std::atomic<std::size_t>(0);
+  auto expected = std::size_t(0);
+
+  auto nanos = Bench::Measure(
+      REPETITIONS, [&] { WaitFor(done, expected); },
+      [&] {
+        for (auto i = std::size_t(0); i < subject.tasks; i++) {
+          executor->Execute(
+              [&] { done.fetch_add(1, std::memory_order_release); });
+        }
+        expected += subject.tasks;
+      });
+  WaitFor(done, expected);
+
+  Bench::Report(subject.name + " submit", subject.tasks,
+                nanos / subject.tasks);
+}
+
+// Submission through completion of empty tasks from one producer.
+void EmptyTask(const Subject& subject) {
+  auto executor = subject.create();
+  auto done = std::atomic<std::size_t>(0);
+  auto expected = std::size_t(0);
+
+  auto nanos = Bench::Measure(REPETITIONS, [&] {
+    for (auto i = std::size_t(0); i < subject.tasks; i++) {
+      executor->Execute(
+          [&] { done.fetch_add(1, std::memory_order_release); });
+    }
+    expected += subject.tasks;
+    WaitFor(done, expected);
+  });
+
+  Bench::Report(subject.name + " empty task", subject.tasks,
+                nanos / subject.tasks);
+}
+
+// The same total number of tasks spread over 1 to N producer threads.
+void Throughput(const Subject& subject, std::size_t producers) {
+  auto executor = subject.create();
+  auto done = std::atomic<std::size_t>(0);
+  auto expected = std::size_t(0);
+  auto perProducer = std::max(subject.tasks / producers, std::size_t(1));
+
+  auto nanos = Bench::Measure(REPETITIONS, [&] {
+    std::vector<std::thread> threads;
+    for (auto p = std::size_t(0); p < producers; p++) {
+      threads.emplace_back([&] {
+        for (auto i = std::size_t(0); i < perProducer; i++) {
+          executor->Execute(
+              [&] { done.fetch_add(1, std::memory_order_release); });
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    expected += perProducer * producers;
+    WaitFor(done, expected);
+  });
+
+  Bench::Report(subject.name + " producers", producers,
+                nanos / (perProducer * producers));
+}
+
+// From Execute to the start of the task on an executor that has been idle
+// long enough for its workers to park.
+void WakeUpLatency(const Subject& subject) {
+  auto executor = subject.create();
+  auto latencies = std::vector<double>();
+
+  for (auto i = std::size_t(0); i < 3 * REPETITIONS; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+    auto latch = Synchronization::CountDownLatch(1);
+    auto started = Clock::time_point();
+    auto submitted = Clock::now();
+    executor->Execute([&] {
+      started = Clock::now();
+      latch.CountDown();
+    });
+    latch.Await();
+
+    latencies.push_back(
+        std::chrono::duration<double, std::nano>(started - submitted)
+            .count());
+  }
+
+  std::nth_element(latencies.begin(),
+                   latencies.begin() + latencies.size() / 2, latencies.end());
+  Bench::Report(subject.name + " wake-up", 1,
+                latencies[latencies.size() / 2]);
+}
+
+// One round: fan out width tasks and wait on a latch until all are done.
+void FanOutFanIn(const Subject& subject, std::size_t width) {
+  auto executor = subject.create();
+
+  auto nanos = Bench::Measure(REPETITIONS, [&] {
+    auto latch = Synchronization::CountDownLatch(width);
+    for (auto i = std::size_t(0); i < width; i++) {
+      executor->Execute([&] { latch.CountDown(); });
+    }
+    latch.Await();
+  });
+
+  Bench::Report(subject.name + " fan-out/in", width, nanos);
+}
+}  // namespace
+
+namespace CppUtils {
+namespace Bench {
+void ExecutorBenchmarks() {
+  auto hardware = std::max(std::thread::hardware_concurrency(), 1u);
+  auto subjects = std::vector<Subject>{
+      {"ThreadPool",
+       [] { return std::make_unique<ThreadPoolExecutor>(); }, 100000},
+      {"WorkStealingPool",
+       [] {
+         auto options = ThreadPoolOptions();
+         options.workStealing = true;
+         return std::make_unique<ThreadPoolExecutor>(options);
+       },
+       100000},
+      {"ThreadPerTask",
+       [] { return std::make_unique<ThreadPerTaskExecutor>(); }, 200},
+  };
+
+  std::vector<std::size_t> producers = {1};
+  for (auto count = std::size_t(2); count <= 2 * hardware; count *= 2) {
+    producers.push_back(count);
+  }
+  if (producers.back() < 4) {
+    producers.push_back(4);
+  }
+
+  for (auto& subject : subjects) {
+    SubmitLatency(subject);
+    EmptyTask(subject);
+    for (auto count : producers) {
+      Throughput(subject, count);
+    }
+    WakeUpLatency(subject);
+    for (auto width : {1, 16, 256}) {
+      FanOutFanIn(subject, static_cast<std::size_t>(width));
+    }
+  }
+}
+}  // namespace Bench
+}  // namespace CppUtils
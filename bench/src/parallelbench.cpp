@@ -0,0 +1,133 @@
+#include <cpputils/parallel.h>
+#include <cpputils/threadpoolexecutor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+using namespace CppUtils;
+
+namespace {
+const std::size_t SIZES[] = {1000, 10000, 100000, 1000000, 10000000};
+
+// Fewer repetitions for the large sizes keep a full run within seconds.
+std::size_t RepetitionsOf(std::size_t size) {
+  return size >= 1000000 ? 5 : 25;
+}
+
+std::vector<uint64_t> RandomData(std::size_t size) {
+  auto engine = std::mt19937_64(size);
+  auto data = std::vector<uint64_t>(size);
+  for (auto& value : data) {
+    value = engine();
+  }
+  return data;
+}
+
+void Sort(Execution::Executor& executor, std::size_t size) {
+  auto source = RandomData(size);
+  auto data = source;
+  auto reps = RepetitionsOf(size);
+  auto setup = [&] { data = source; };
+
+  auto serial =
+      Bench::Measure(reps, setup, [&] { std::sort(data.begin(), data.end()); });
+  auto parallel = Bench::Measure(
+      reps, setup, [&] { Parallel::Sort(executor, data.begin(), data.end()); });
+
+  Bench::Report("std::sort", size, serial, serial);
+  Bench::Report("Parallel::Sort", size, parallel, serial);
+}
+
+void Reduce(Execution::Executor& executor, std::size_t size) {
+  auto data = RandomData(size);
+  auto reps = RepetitionsOf(size);
+
+  auto serial = Bench::Measure(reps, [&] {
+    Bench::Consume(std::accumulate(data.begin(), data.end(), uint64_t(0)));
+  });
+  auto parallel = Bench::Measure(reps, [&] {
+    Bench::Consume(
+        Parallel::Reduce(executor, data.begin(), data.end(), uint64_t(0)));
+  });
+
+  Bench::Report("std::accumulate", size, serial, serial);
+  Bench::Report("Parallel::Reduce", size, parallel, serial);
+}
+
+// A heavier element function, where the parallel versions pay off sooner.
+void TransformReduce(Execution::Executor& executor, std::size_t size) {
+  auto data = RandomData(size);
+  auto reps = RepetitionsOf(size);
+  auto transform = [](uint64_t value) {
+    return std::sqrt(static_cast<double>(value));
+  };
+
+  auto serial = Bench::Measure(reps, [&] {
+    auto sum = 0.0;
+    for (auto value : data) {
+      sum += transform(value);
+    }
+    Bench::Consume(sum);
+  });
+  auto parallel = Bench::Measure(reps, [&] {
+    Bench::Consume(Parallel::TransformReduce(executor, data.begin(),
+                                             data.end(), 0.0, std::plus<>(),
+                                             transform));
+  });
+
+  Bench::Report("serial transform-reduce", size, serial, serial);
+  Bench::Report("Parallel::TransformReduce", size, parallel, serial);
+}
+
+void InclusiveScan(Execution::Executor& executor, std::size_t size) {
+  auto data = RandomData(size);
+  auto out = std::vector<uint64_t>(size);
+  auto reps = RepetitionsOf(size);
+
+  auto serial = Bench::Measure(
+      reps, [&] { std::partial_sum(data.begin(), data.end(), out.begin()); });
+  auto parallel = Bench::Measure(reps, [&] {
+    Parallel::InclusiveScan(executor, data.begin(), data.end(), out.begin());
+  });
+
+  Bench::Report("std::partial_sum", size, serial, serial);
+  Bench::Report("Parallel::InclusiveScan", size, parallel, serial);
+}
+
+void ForEach(Execution::Executor& executor, std::size_t size) {
+  auto data = RandomData(size);
+  auto reps = RepetitionsOf(size);
+  auto function = [](uint64_t& value) { value = value * 31 + 7; };
+
+  auto serial = Bench::Measure(
+      reps, [&] { std::for_each(data.begin(), data.end(), function); });
+  auto parallel = Bench::Measure(reps, [&] {
+    Parallel::ForEach(executor, data.begin(), data.end(), function);
+  });
+
+  Bench::Report("std::for_each", size, serial, serial);
+  Bench::Report("Parallel::ForEach", size, parallel, serial);
+}
+}  // namespace
+
+namespace CppUtils {
+namespace Bench {
+void ParallelBenchmarks() {
+  auto executor = Execution::ThreadPoolExecutor();
+
+  for (auto benchmark : {Sort, Reduce, TransformReduce, InclusiveScan,
+                         ForEach}) {
+    for (auto size : SIZES) {
+      benchmark(executor, size);
+    }
+  }
+}
+}  // namespace Bench
+}  // namespace CppUtils
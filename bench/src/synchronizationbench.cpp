@@ -0,0 +1,100 @@
+#include <cpputils/seqlock.h>
+#include <cpputils/shardedsharedmutex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+
+using namespace CppUtils;
+using namespace CppUtils::Synchronization;
+
+namespace {
+const std::size_t REPETITIONS = 5;
+const std::size_t READS = 200000;
+
+// A small read-mostly table entry, such as a route or a config snapshot.
+struct Route {
+  uint64_t address;
+  uint64_t mask;
+  uint32_t port;
+  uint32_t weight;
+};
+
+// Runs readers threads that each call read READS times, started together;
+// returns nanoseconds per read over all threads.
+template <typename Read>
+double Readers(std::size_t readers, Read&& read) {
+  auto nanos = Bench::Measure(REPETITIONS, [&] {
+    auto ready = std::atomic<std::size_t>(0);
+    std::vector<std::thread> threads;
+    for (auto r = std::size_t(0); r < readers; r++) {
+      threads.emplace_back([&] {
+        ready++;
+        while (ready.load() < readers) {
+          std::this_thread::yield();
+        }
+
+        auto sum = uint64_t(0);
+        for (auto i = std::size_t(0); i < READS; i++) {
+          sum += read().port;
+        }
+        Bench::Consume(sum);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
+  return nanos / static_cast<double>(READS * readers);
+}
+
+void ReadScaling(std::size_t readers) {
+  auto route = Route{0x0a000000, 0xff000000, 8080, 1};
+
+  auto sharedMutex = std::shared_mutex();
+  auto baseline = Readers(readers, [&] {
+    auto lock = std::shared_lock<std::shared_mutex>(sharedMutex);
+    return route;
+  });
+
+  auto sharded = ShardedSharedMutex();
+  auto shardedNanos = Readers(readers, [&] {
+    auto lock = std::shared_lock<ShardedSharedMutex>(sharded);
+    return route;
+  });
+
+  auto seqLock = SeqLock<Route>(route);
+  auto seqLockNanos = Readers(readers, [&] { return seqLock.Load(); });
+
+  Bench::Report("std::shared_mutex read", readers, baseline, baseline);
+  Bench::Report("ShardedSharedMutex read", readers, shardedNanos, baseline);
+  Bench::Report("SeqLock read", readers, seqLockNanos, baseline);
+}
+}  // namespace
+
+namespace CppUtils {
+namespace Bench {
+void SynchronizationBenchmarks() {
+  auto hardware = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::vector<std::size_t> readers = {1};
+  for (auto count = std::size_t(2); count <= hardware; count *= 2) {
+    readers.push_back(count);
+  }
+  if (readers.back() != hardware) {
+    readers.push_back(hardware);
+  }
+
+  for (auto count : readers) {
+    ReadScaling(count);
+  }
+}
+}  // namespace Bench
+}  // namespace CppUtils
@@ -0,0 +1,726 @@
+#include "asyncfiles.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "logger.h"
+#include "profiledmutex.h"
+#include "threadpoolexecutor.h"
+
+namespace CppUtils {
+struct FileOperation {
+  uint8_t opcode = IORING_OP_NOP;
+  int fd = -1;
+  std::string path;
+  void* address = nullptr;
+  uint32_t length = 0;
+  uint64_t offset = 0;
+  uint32_t flags = 0;
+  uint16_t bufferIndex = 0;
+  struct statx stat = {};
+
+  // Called once with the result: a count, a descriptor or -errno.
+  std::function<void(FileOperation&, int)> complete;
+};
+
+namespace {
+// Every opcode AsyncFiles issues.
+constexpr uint8_t OPCODES[] = {
+    IORING_OP_OPENAT, IORING_OP_READ,       IORING_OP_WRITE,
+    IORING_OP_FSYNC,  IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED,
+    IORING_OP_STATX,  IORING_OP_CLOSE};
+
+// Kernels that cannot probe predate OPENAT, STATX and CLOSE as well.
+bool supportsOpcodes(int fd) {
+  constexpr auto maxOps = 256u;
+  auto memory = std::vector<char>(sizeof(io_uring_probe) +
+                                  maxOps * sizeof(io_uring_probe_op));
+  auto* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+  if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+              maxOps) < 0) {
+    return false;
+  }
+
+  for (auto opcode : OPCODES) {
+    if (opcode >= probe->ops_len ||
+        !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t clampLength(std::size_t size) {
+  return static_cast<uint32_t>(
+      std::min<std::size_t>(size, std::numeric_limits<uint32_t>::max()));
+}
+
+// The blocking equivalent of an operation, for the fallback pool.
+int perform(FileOperation& operation) {
+  auto result = 0l;
+  switch (operation.opcode) {
+    case IORING_OP_OPENAT:
+      result = openat(AT_FDCWD, operation.path.c_str(),
+                      static_cast<int>(operation.flags), operation.length);
+      break;
+    case IORING_OP_READ:
+    case IORING_OP_READ_FIXED:
+      result = pread(operation.fd, operation.address, operation.length,
+                     static_cast<off_t>(operation.offset));
+      break;
+    case IORING_OP_WRITE:
+    case IORING_OP_WRITE_FIXED:
+      result = pwrite(operation.fd, operation.address, operation.length,
+                      static_cast<off_t>(operation.offset));
+      break;
+    case IORING_OP_FSYNC:
+      result = (operation.flags & IORING_FSYNC_DATASYNC)
+                   ? fdatasync(operation.fd)
+                   : fsync(operation.fd);
+      break;
+    case IORING_OP_STATX:
+      result = statx(AT_FDCWD, operation.path.c_str(), 0, STATX_BASIC_STATS,
+                     &operation.stat);
+      break;
+    case IORING_OP_CLOSE:
+      result = close(operation.fd);
+      break;
+    default:
+      return -EINVAL;
+  }
+  return result < 0 ? -errno : static_cast<int>(result);
+}
+
+std::exception_ptr failureOf(const FileOperation& operation, int result) {
+  auto name = "file operation";
+  switch (operation.opcode) {
+    case IORING_OP_OPENAT:
+      name = "open";
+      break;
+    case IORING_OP_READ:
+    case IORING_OP_READ_FIXED:
+      name = "read";
+      break;
+    case IORING_OP_WRITE:
+    case IORING_OP_WRITE_FIXED:
+      name = "write";
+      break;
+    case IORING_OP_FSYNC:
+      name = "sync";
+      break;
+    case IORING_OP_STATX:
+      name = "stat";
+      break;
+    case IORING_OP_CLOSE:
+      name = "close";
+      break;
+  }
+
+  auto target = operation.path.empty() ? std::string()
+                                       : " " + operation.path;
+  return std::make_exception_ptr(std::runtime_error(
+      std::string("failed to ") + name + target + ": " +
+      std::strerror(-result)));
+}
+
+void finish(FileOperation* operation, int result) {
+  auto owned = std::unique_ptr<FileOperation>(operation);
+  try {
+    owned->complete(*owned, result);
+  } catch (const std::exception& ex) {
+    Logger::Error("AsyncFiles caught exception: {}", ex.what());
+  }
+}
+}  // namespace
+
+// A raw io_uring instance: one mmap'ed submission and completion ring and a
+// thread reaping completions. Submissions are serialized by a mutex; each
+// holder fills entries and enters the kernel once for all of them.
+class AsyncFiles::Ring {
+ public:
+  static std::unique_ptr<Ring> Create(uint32_t entries) {
+    auto params = io_uring_params();
+    auto fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return nullptr;
+    }
+    if (!supportsOpcodes(fd)) {
+      close(fd);
+      return nullptr;
+    }
+
+    try {
+      return std::unique_ptr<Ring>(new Ring(fd, params));
+    } catch (const std::runtime_error&) {
+      close(fd);
+      return nullptr;
+    }
+  }
+
+  ~Ring() {
+    {
+      auto lock = Synchronization::InternalLock(mx);
+      space.wait(lock, [this] { return inFlight == 0; });
+
+      // Wakes the reaper; user_data 0 marks the stop request.
+      auto* entry = next();
+      entry->opcode = IORING_OP_NOP;
+      entry->user_data = 0;
+      if (auto result = enter(false); result < 0) {
+        Logger::Error("AsyncFiles could not stop io_uring: {}",
+                      std::strerror(-result));
+      }
+    }
+    reaper.join();
+
+    munmap(sqes, sqesSize);
+    if (cqMemory != sqMemory) {
+      munmap(cqMemory, cqSize);
+    }
+    munmap(sqMemory, sqSize);
+    close(fd);
+  }
+
+  // If the kernel refuses the entries, every operation it has not taken
+  // fails with the error instead.
+  void Submit(std::vector<std::unique_ptr<FileOperation>>& operations) {
+    auto onReaper = std::this_thread::get_id() == reaper.get_id();
+    auto lock = Synchronization::InternalLock(mx);
+
+    auto submitted = std::size_t(0);
+    while (submitted < operations.size()) {
+      // The reaper cannot wait for its own completions; the kernel keeps
+      // the overflow until it catches up.
+      if (!onReaper) {
+        space.wait(lock, [this] { return inFlight < cqEntries; });
+      }
+
+      auto count = std::min<std::size_t>(
+          {operations.size() - submitted, sqEntries,
+           onReaper ? sqEntries : cqEntries - inFlight});
+      for (auto i = submitted; i < submitted + count; i++) {
+        fill(next(), operations[i].release());
+      }
+      inFlight += count;
+      submitted += count;
+
+      auto result = enter(onReaper);
+      while (result == -EBUSY) {
+        // Nobody but the reaper drains the completions it waits for.
+        lock.unlock();
+        reapCompleted();
+        lock.lock();
+        result = enter(onReaper);
+      }
+
+      if (result < 0) {
+        auto failed = takeBack();
+        for (auto i = submitted; i < operations.size(); i++) {
+          failed.emplace_back(operations[i].release());
+        }
+        lock.unlock();
+
+        for (auto* operation : failed) {
+          finish(operation, result);
+        }
+        return;
+      }
+    }
+  }
+
+  void RegisterBuffers(const std::vector<iovec>& buffers) {
+    auto lock = Synchronization::InternalLock(mx);
+    if (registered) {
+      syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_BUFFERS, nullptr,
+              0);
+      registered = false;
+    }
+    if (buffers.empty()) {
+      return;
+    }
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                buffers.data(), static_cast<unsigned>(buffers.size())) < 0) {
+      throw std::runtime_error(std::string("failed to register buffers: ") +
+                               std::strerror(errno));
+    }
+    registered = true;
+  }
+
+ private:
+  Ring(int fd, const io_uring_params& params)
+      : fd(fd),
+        sqEntries(params.sq_entries),
+        cqEntries(params.cq_entries),
+        inFlight(0),
+        registered(false) {
+    sqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sqSize = cqSize = std::max(sqSize, cqSize);
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    sqMemory = map(sqSize, IORING_OFF_SQ_RING);
+    cqMemory = (params.features & IORING_FEAT_SINGLE_MMAP)
+                   ? sqMemory
+                   : map(cqSize, IORING_OFF_CQ_RING);
+    sqes = static_cast<io_uring_sqe*>(map(sqesSize, IORING_OFF_SQES));
+
+    auto* sq = static_cast<char*>(sqMemory);
+    sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+    auto* cq = static_cast<char*>(cqMemory);
+    cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    reaper = std::thread(&Ring::reap, this);
+  }
+
+  void* map(std::size_t size, uint64_t offset) {
+    auto* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd,
+                        static_cast<off_t>(offset));
+    if (memory == MAP_FAILED) {
+      throw std::runtime_error("failed to map io_uring");
+    }
+    return memory;
+  }
+
+  // Claims the next submission entry; the kernel consumes every entry
+  // during enter(), so the ring never fills up between calls.
+  io_uring_sqe* next() {
+    auto tail = *sqTail + pending;
+    auto index = tail & sqMask;
+    sqArray[index] = index;
+    pending++;
+
+    auto* entry = &sqes[index];
+    std::memset(entry, 0, sizeof(*entry));
+    return entry;
+  }
+
+  void fill(io_uring_sqe* entry, FileOperation* operation) {
+    entry->opcode = operation->opcode;
+    entry->fd = operation->fd;
+    entry->user_data = reinterpret_cast<uint64_t>(operation);
+
+    switch (operation->opcode) {
+      case IORING_OP_OPENAT:
+        entry->fd = AT_FDCWD;
+        entry->addr = reinterpret_cast<uint64_t>(operation->path.c_str());
+        entry->len = operation->length;
+        entry->open_flags = operation->flags;
+        break;
+      case IORING_OP_STATX:
+        entry->fd = AT_FDCWD;
+        entry->addr = reinterpret_cast<uint64_t>(operation->path.c_str());
+        entry->len = STATX_BASIC_STATS;
+        entry->off = reinterpret_cast<uint64_t>(&operation->stat);
+        break;
+      case IORING_OP_FSYNC:
+        entry->fsync_flags = operation->flags;
+        break;
+      case IORING_OP_READ_FIXED:
+      case IORING_OP_WRITE_FIXED:
+        entry->buf_index = operation->bufferIndex;
+        [[fallthrough]];
+      case IORING_OP_READ:
+      case IORING_OP_WRITE:
+        entry->addr = reinterpret_cast<uint64_t>(operation->address);
+        entry->len = operation->length;
+        entry->off = operation->offset;
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Publishes the claimed entries and hands the kernel every entry it has
+  // not consumed yet. Returns 0 or -errno. A full completion queue makes the
+  // kernel refuse with EBUSY until it is drained; other threads wait for the
+  // reaper, the reaper gets the error back to drain it.
+  int enter(bool onReaper) {
+    __atomic_store_n(sqTail, *sqTail + pending, __ATOMIC_RELEASE);
+    pending = 0;
+
+    while (true) {
+      auto count = *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+      if (count == 0) {
+        return 0;
+      }
+
+      auto result = syscall(__NR_io_uring_enter, fd, count, 0, 0, nullptr, 0);
+      if (result < 0) {
+        if (errno == EINTR || errno == EAGAIN ||
+            (errno == EBUSY && !onReaper)) {
+          continue;
+        }
+        return -errno;
+      }
+    }
+  }
+
+  // Withdraws the entries the kernel has not consumed and returns their
+  // operations. Called with the lock held.
+  std::vector<FileOperation*> takeBack() {
+    auto head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+
+    std::vector<FileOperation*> operations;
+    for (auto i = head; i != *sqTail; i++) {
+      auto data = sqes[sqArray[i & sqMask]].user_data;
+      if (data != 0) {
+        operations.emplace_back(reinterpret_cast<FileOperation*>(data));
+      }
+    }
+    __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+
+    inFlight -= operations.size();
+    space.notify_all();
+    return operations;
+  }
+
+  void reap() {
+    while (!stopped) {
+      if (*cqHead == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr,
+                0);
+        continue;
+      }
+      reapCompleted();
+    }
+  }
+
+  // Completes what the kernel has posted. Each entry is consumed before its
+  // callback runs, so a callback that submits from the reaper may reap
+  // again from within Submit.
+  void reapCompleted() {
+    auto completed = std::size_t(0);
+    while (true) {
+      auto head = *cqHead;
+      if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        break;
+      }
+
+      auto entry = cqes[head & cqMask];
+      __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+      if (entry.user_data == 0) {
+        stopped = true;
+        continue;
+      }
+      finish(reinterpret_cast<FileOperation*>(entry.user_data), entry.res);
+      completed++;
+    }
+
+    if (completed > 0) {
+      auto lock = Synchronization::InternalLock(mx);
+      inFlight -= completed;
+      space.notify_all();
+    }
+  }
+
+ private:
+  const int fd;
+  const std::size_t sqEntries;
+  const std::size_t cqEntries;
+
+  void* sqMemory;
+  void* cqMemory;
+  std::size_t sqSize;
+  std::size_t cqSize;
+  io_uring_sqe* sqes;
+  std::size_t sqesSize;
+
+  uint32_t* sqHead;
+  uint32_t* sqTail;
+  uint32_t sqMask;
+  uint32_t* sqArray;
+  uint32_t pending = 0;
+
+  uint32_t* cqHead;
+  uint32_t* cqTail;
+  uint32_t cqMask;
+  io_uring_cqe* cqes;
+
+  std::size_t inFlight;
+  bool registered;
+
+  // Set by the reaper when it sees the stop request.
+  bool stopped = false;
+
+  Synchronization::InternalMutex mx{"AsyncFiles::Ring::mx"};
+  Synchronization::InternalConditionVariable space;
+  std::thread reaper;
+};
+
+// The blocking calls on a thread pool. The pool drops the tasks still queued
+// when it is destroyed, so the destructor first waits for every operation.
+class AsyncFiles::Fallback {
+ public:
+  explicit Fallback(uint32_t threads) : pool(threads), inFlight(0) {}
+
+  ~Fallback() {
+    auto lock = Synchronization::InternalLock(mx);
+    idle.wait(lock, [this] { return inFlight == 0; });
+  }
+
+  void Submit(std::vector<std::unique_ptr<FileOperation>>& operations) {
+    for (auto& operation : operations) {
+      {
+        auto lock = Synchronization::InternalLock(mx);
+        inFlight++;
+      }
+
+      // A task dropped unrun destroys its operation, which breaks the
+      // promise instead of leaking it.
+      try {
+        pool.Execute([this, operation = std::move(operation)]() mutable {
+          auto result = perform(*operation);
+          finish(operation.release(), result);
+          done();
+        });
+      } catch (const std::exception&) {
+        done();
+        throw;
+      }
+    }
+  }
+
+ private:
+  void done() {
+    auto lock = Synchronization::InternalLock(mx);
+    if (--inFlight == 0) {
+      idle.notify_all();
+    }
+  }
+
+ private:
+  Execution::ThreadPoolExecutor pool;
+  std::size_t inFlight;
+  Synchronization::InternalMutex mx{"AsyncFiles::Fallback::mx"};
+  Synchronization::InternalConditionVariable idle;
+};
+
+AsyncFiles::AsyncFiles(const AsyncFilesOptions& options)
+    : executor(options.executor) {
+  if (!options.forceFallback) {
+    ring = Ring::Create(std::max(options.queueDepth, 1u));
+  }
+  if (!ring) {
+    fallback =
+        std::make_unique<Fallback>(std::max(options.fallbackThreads, 1u));
+  }
+}
+
+// Both wait for the operations in flight, so completions never outlive the
+// members they use.
+AsyncFiles::~AsyncFiles() {
+  ring.reset();
+  fallback.reset();
+}
+
+bool AsyncFiles::IsUsingIoUring() const { return ring != nullptr; }
+
+Execution::Future<int> AsyncFiles::Open(const fs::path& path, int flags,
+                                        mode_t mode) {
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_OPENAT;
+  operation->path = path.string();
+  operation->flags = static_cast<uint32_t>(flags | O_CLOEXEC);
+  operation->length = mode;
+  return start<int>(std::move(operation),
+                    [](FileOperation&, int result) { return result; });
+}
+
+Execution::Future<std::size_t> AsyncFiles::Read(int fd, void* buffer,
+                                                std::size_t size,
+                                                uint64_t offset) {
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_READ;
+  operation->fd = fd;
+  operation->address = buffer;
+  operation->length = clampLength(size);
+  operation->offset = offset;
+  return transfer(std::move(operation));
+}
+
+Execution::Future<std::size_t> AsyncFiles::Write(int fd, const void* buffer,
+                                                 std::size_t size,
+                                                 uint64_t offset) {
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_WRITE;
+  operation->fd = fd;
+  operation->address = const_cast<void*>(buffer);
+  operation->length = clampLength(size);
+  operation->offset = offset;
+  return transfer(std::move(operation));
+}
+
+std::vector<Execution::Future<std::size_t>> AsyncFiles::ReadBatch(
+    const std::vector<ReadRequest>& requests) {
+  std::vector<std::unique_ptr<FileOperation>> operations;
+  std::vector<Execution::Future<std::size_t>> futures;
+  operations.reserve(requests.size());
+  futures.reserve(requests.size());
+
+  for (auto& request : requests) {
+    auto operation = std::make_unique<FileOperation>();
+    operation->opcode = IORING_OP_READ;
+    operation->fd = request.fd;
+    operation->address = request.buffer;
+    operation->length = clampLength(request.size);
+    operation->offset = request.offset;
+
+    auto promise = Execution::Promise<std::size_t>(executor);
+    futures.emplace_back(promise.GetFuture());
+    operation->complete = [promise](FileOperation& completed, int result) {
+      if (result < 0) {
+        promise.SetException(failureOf(completed, result));
+        return;
+      }
+      promise.SetValue(static_cast<std::size_t>(result));
+    };
+    operations.emplace_back(std::move(operation));
+  }
+
+  submit(operations);
+  return futures;
+}
+
+Execution::Future<void> AsyncFiles::Sync(int fd, bool dataOnly) {
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_FSYNC;
+  operation->fd = fd;
+  operation->flags = dataOnly ? IORING_FSYNC_DATASYNC : 0;
+  return start<void>(std::move(operation), [](FileOperation&, int) {});
+}
+
+Execution::Future<struct statx> AsyncFiles::Stat(const fs::path& path) {
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_STATX;
+  operation->path = path.string();
+  return start<struct statx>(
+      std::move(operation),
+      [](FileOperation& completed, int) { return completed.stat; });
+}
+
+Execution::Future<void> AsyncFiles::Close(int fd) {
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_CLOSE;
+  operation->fd = fd;
+  return start<void>(std::move(operation), [](FileOperation&, int) {});
+}
+
+void AsyncFiles::RegisterBuffers(const std::vector<iovec>& buffers) {
+  if (ring) {
+    ring->RegisterBuffers(buffers);
+  }
+  registered = buffers;
+}
+
+Execution::Future<std::size_t> AsyncFiles::ReadFixed(int fd,
+                                                     uint32_t bufferIndex,
+                                                     void* buffer,
+                                                     std::size_t size,
+                                                     uint64_t offset) {
+  checkFixed(bufferIndex, buffer, size);
+
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_READ_FIXED;
+  operation->fd = fd;
+  operation->address = buffer;
+  operation->length = clampLength(size);
+  operation->offset = offset;
+  operation->bufferIndex = static_cast<uint16_t>(bufferIndex);
+  return transfer(std::move(operation));
+}
+
+Execution::Future<std::size_t> AsyncFiles::WriteFixed(int fd,
+                                                      uint32_t bufferIndex,
+                                                      const void* buffer,
+                                                      std::size_t size,
+                                                      uint64_t offset) {
+  checkFixed(bufferIndex, buffer, size);
+
+  auto operation = std::make_unique<FileOperation>();
+  operation->opcode = IORING_OP_WRITE_FIXED;
+  operation->fd = fd;
+  operation->address = const_cast<void*>(buffer);
+  operation->length = clampLength(size);
+  operation->offset = offset;
+  operation->bufferIndex = static_cast<uint16_t>(bufferIndex);
+  return transfer(std::move(operation));
+}
+
+template <typename T, typename F>
+Execution::Future<T> AsyncFiles::start(
+    std::unique_ptr<FileOperation> operation, F convert) {
+  auto promise = Execution::Promise<T>(executor);
+  auto future = promise.GetFuture();
+
+  operation->complete = [promise, convert](FileOperation& completed,
+                                           int result) {
+    if (result < 0) {
+      promise.SetException(failureOf(completed, result));
+      return;
+    }
+    promise.SetResultOf([&] { return convert(completed, result); });
+  };
+
+  std::vector<std::unique_ptr<FileOperation>> operations;
+  operations.emplace_back(std::move(operation));
+  submit(operations);
+  return future;
+}
+
+Execution::Future<std::size_t> AsyncFiles::transfer(
+    std::unique_ptr<FileOperation> operation) {
+  return start<std::size_t>(
+      std::move(operation), [](FileOperation&, int result) {
+        return static_cast<std::size_t>(result);
+      });
+}
+
+void AsyncFiles::submit(
+    std::vector<std::unique_ptr<FileOperation>>& operations) {
+  if (ring) {
+    ring->Submit(operations);
+    return;
+  }
+
+  fallback->Submit(operations);
+}
+
+void AsyncFiles::checkFixed(uint32_t bufferIndex, const void* buffer,
+                            std::size_t size) const {
+  if (bufferIndex >= registered.size()) {
+    throw std::runtime_error("invalid registered buffer index");
+  }
+
+  auto& registeredBuffer = registered[bufferIndex];
+  auto* begin = static_cast<const char*>(registeredBuffer.iov_base);
+  auto* data = static_cast<const char*>(buffer);
+  if (data < begin || data + size > begin + registeredBuffer.iov_len) {
+    throw std::runtime_error("buffer outside of registered buffer");
+  }
+}
+}  // namespace CppUtils
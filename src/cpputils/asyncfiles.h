@@ -0,0 +1,106 @@
+#pragma once
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "future.h"
+
+namespace CppUtils {
+namespace fs = std::filesystem;
+
+struct FileOperation;
+
+struct AsyncFilesOptions {
+  // Submission queue entries of the ring; at most twice as many operations
+  // are in flight at once, further submissions wait for completions.
+  uint32_t queueDepth = 256;
+
+  // Threads running the blocking calls when io_uring is unavailable (old
+  // kernels, kernels missing one of the opcodes used, seccomp-restricted
+  // containers) or forceFallback is set.
+  uint32_t fallbackThreads = 4;
+  bool forceFallback = false;
+
+  // Continuations attached to the returned futures run here; without an
+  // executor they run on the thread that completes the operation.
+  Execution::Executor* executor = nullptr;
+};
+
+struct ReadRequest {
+  int fd;
+  void* buffer;
+  std::size_t size;
+  uint64_t offset;
+};
+
+// Asynchronous file I/O on io_uring: every call queues one operation and
+// returns a future of its result, so one thread can keep many requests in
+// flight. Operations submitted from several threads at once are passed to
+// the kernel together, ReadBatch submits all of its reads with one system
+// call, and buffers registered with RegisterBuffers are mapped into the
+// kernel once instead of on every ReadFixed/WriteFixed. Failures surface as
+// std::runtime_error from the future. Reads and writes may transfer fewer
+// bytes than asked, like pread and pwrite. Buffers and descriptors must stay
+// valid until the operation completes; the destructor waits for all of
+// them, including calls still queued for the fallback pool. Linux only.
+class AsyncFiles {
+ public:
+  AsyncFiles(const AsyncFilesOptions& options = AsyncFilesOptions());
+  ~AsyncFiles();
+
+  bool IsUsingIoUring() const;
+
+  Execution::Future<int> Open(const fs::path& path, int flags,
+                              mode_t mode = 0644);
+  Execution::Future<std::size_t> Read(int fd, void* buffer, std::size_t size,
+                                      uint64_t offset);
+  Execution::Future<std::size_t> Write(int fd, const void* buffer,
+                                       std::size_t size, uint64_t offset);
+  std::vector<Execution::Future<std::size_t>> ReadBatch(
+      const std::vector<ReadRequest>& requests);
+  Execution::Future<void> Sync(int fd, bool dataOnly = false);
+  Execution::Future<struct statx> Stat(const fs::path& path);
+  Execution::Future<void> Close(int fd);
+
+  // Replaces the registered buffers; no fixed operation may be in flight.
+  void RegisterBuffers(const std::vector<iovec>& buffers);
+
+  // buffer and size must lie within the registered buffer bufferIndex.
+  Execution::Future<std::size_t> ReadFixed(int fd, uint32_t bufferIndex,
+                                           void* buffer, std::size_t size,
+                                           uint64_t offset);
+  Execution::Future<std::size_t> WriteFixed(int fd, uint32_t bufferIndex,
+                                            const void* buffer,
+                                            std::size_t size,
+                                            uint64_t offset);
+
+  AsyncFiles(const AsyncFiles&) = delete;
+  AsyncFiles& operator=(const AsyncFiles&) = delete;
+
+ private:
+  class Ring;
+  class Fallback;
+
+  template <typename T, typename F>
+  Execution::Future<T> start(std::unique_ptr<FileOperation> operation,
+                             F convert);
+  Execution::Future<std::size_t> transfer(
+      std::unique_ptr<FileOperation> operation);
+  void submit(std::vector<std::unique_ptr<FileOperation>>& operations);
+  void checkFixed(uint32_t bufferIndex, const void* buffer,
+                  std::size_t size) const;
+
+ private:
+  Execution::Executor* const executor;
+  std::vector<iovec> registered;
+
+  std::unique_ptr<Ring> ring;
+  std::unique_ptr<Fallback> fallback;
+};
+}  // namespace CppUtils
@@ -0,0 +1,118 @@
+#include "atomicwait.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+#include "profiledmutex.h"
+#endif
+
+namespace CppUtils {
+namespace Synchronization {
+#ifdef __linux__
+namespace {
+void futex(const std::atomic<uint32_t>& value, int operation, uint32_t arg) {
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "futex needs a plain 32-bit word");
+
+  syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&value),
+          operation | FUTEX_PRIVATE_FLAG, arg, nullptr, nullptr, 0);
+}
+}  // namespace
+
+void AtomicWait(const std::atomic<uint32_t>& value, uint32_t expected) {
+  futex(value, FUTEX_WAIT, expected);
+}
+
+// FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline, the clock
+// behind steady_clock on Linux, so retries after signals need no
+// recomputation.
+bool AtomicWaitUntil(const std::atomic<uint32_t>& value, uint32_t expected,
+                     std::chrono::steady_clock::time_point deadline) {
+  auto sinceEpoch = deadline.time_since_epoch();
+  if (sinceEpoch <= std::chrono::steady_clock::now().time_since_epoch()) {
+    return false;
+  }
+
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+  auto timeout = timespec();
+  timeout.tv_sec = static_cast<time_t>(seconds.count());
+  timeout.tv_nsec = static_cast<long>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch -
+                                                           seconds)
+          .count());
+
+  auto result =
+      syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&value),
+              FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, expected, &timeout,
+              nullptr, FUTEX_BITSET_MATCH_ANY);
+  return result == 0 || errno != ETIMEDOUT;
+}
+
+void AtomicNotifyOne(const std::atomic<uint32_t>& value) {
+  futex(value, FUTEX_WAKE, 1);
+}
+
+void AtomicNotifyAll(const std::atomic<uint32_t>& value) {
+  futex(value, FUTEX_WAKE, INT_MAX);
+}
+#else
+namespace {
+struct alignas(64) Bucket {
+  InternalMutex mx{"AtomicWait::Bucket::mx"};
+  InternalConditionVariable cv;
+};
+
+Bucket& bucketOf(const std::atomic<uint32_t>& value) {
+  static Bucket buckets[64];
+  auto hash = std::hash<const void*>()(&value);
+  return buckets[(hash >> 4) % 64];
+}
+}  // namespace
+
+void AtomicWait(const std::atomic<uint32_t>& value, uint32_t expected) {
+  auto& bucket = bucketOf(value);
+  auto lock = InternalLock(bucket.mx);
+
+  if (value.load() == expected) {
+    bucket.cv.wait(lock);
+  }
+}
+
+bool AtomicWaitUntil(const std::atomic<uint32_t>& value, uint32_t expected,
+                     std::chrono::steady_clock::time_point deadline) {
+  auto& bucket = bucketOf(value);
+  auto lock = InternalLock(bucket.mx);
+
+  if (value.load() == expected) {
+    return bucket.cv.wait_until(lock, deadline) == std::cv_status::no_timeout;
+  }
+  return true;
+}
+
+// A bucket is shared by unrelated addresses, so waking one waiter could pick
+// the wrong one; everyone in the bucket wakes and rechecks instead.
+void AtomicNotifyOne(const std::atomic<uint32_t>& value) {
+  AtomicNotifyAll(value);
+}
+
+void AtomicNotifyAll(const std::atomic<uint32_t>& value) {
+  auto& bucket = bucketOf(value);
+  {
+    auto lock = InternalLock(bucket.mx);
+  }
+  bucket.cv.notify_all();
+}
+#endif
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace CppUtils {
+namespace Synchronization {
+// Blocks while value holds expected; may also return spuriously. On Linux
+// this is a private futex wait, elsewhere a mutex and condition variable
+// picked by the address from a small table.
+void AtomicWait(const std::atomic<uint32_t>& value, uint32_t expected);
+
+// Like AtomicWait, but gives up at deadline; returns false once it has
+// passed.
+bool AtomicWaitUntil(const std::atomic<uint32_t>& value, uint32_t expected,
+                     std::chrono::steady_clock::time_point deadline);
+
+// Wake threads blocked in AtomicWait on value. Change the value first.
+void AtomicNotifyOne(const std::atomic<uint32_t>& value);
+void AtomicNotifyAll(const std::atomic<uint32_t>& value);
+
+// Tells the CPU it is in a spin-wait loop, which saves power and frees the
+// core for its hyper-thread sibling.
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,151 @@
+#include "cachedthreadpoolexecutor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace CppUtils {
+namespace Execution {
+CachedThreadPoolExecutor::CachedThreadPoolExecutor(
+    uint32_t maxThreads, std::chrono::milliseconds idleTimeout)
+    : maxThreads(std::max(maxThreads, 1u)),
+      idleTimeout(idleTimeout),
+      running(true),
+      threads(0u),
+      idle(0u) {}
+
+CachedThreadPoolExecutor::~CachedThreadPoolExecutor() {
+  auto lock = Synchronization::InternalLock(mx);
+  auto predicate = [this] { return threads == 0u; };
+
+  running = false;
+  cv.notify_all();
+
+  finished.wait(lock, predicate);
+
+  for (auto& worker : workers) {
+    worker.second.join();
+  }
+}
+
+// The thread is started before the task is queued: if that fails while no
+// other thread is left to run it, the submission fails instead of leaving
+// the task stranded.
+void CachedThreadPoolExecutor::Execute(Task&& task) {
+  auto lock = Synchronization::InternalLock(mx);
+
+  if (tasks.Size() < idle || threads == maxThreads) {
+    tasks.PushBack(std::move(task));
+    cv.notify_one();
+    return;
+  }
+  threads++;
+  lock.unlock();
+
+  std::thread worker;
+  try {
+    worker = std::thread(&CachedThreadPoolExecutor::threadFunc, this);
+  } catch (const std::exception& ex) {
+    lock.lock();
+    threads--;
+    finished.notify_all();
+
+    Logger::Error("CachedThreadPoolExecutor failed to start thread: {}",
+                  ex.what());
+    if (threads == 0u) {
+      throw std::runtime_error("failed to start thread");
+    }
+
+    // A busy thread gets to it once it is done.
+    tasks.PushBack(std::move(task));
+    return;
+  }
+
+  lock.lock();
+  tasks.PushBack(std::move(task));
+  cv.notify_one();
+
+  workers.emplace(worker.get_id(), std::move(worker));
+  reap(lock);
+}
+
+// Callers such as the parallel algorithms size their helpers by this, so it
+// is the hardware rather than the thread limit.
+uint32_t CachedThreadPoolExecutor::GetConcurrency() const {
+  auto hardware = std::max(std::thread::hardware_concurrency(), 1u);
+  return std::min(maxThreads, hardware);
+}
+
+uint32_t CachedThreadPoolExecutor::GetThreadCount() {
+  auto lock = Synchronization::InternalLock(mx);
+  return threads;
+}
+
+uint32_t CachedThreadPoolExecutor::GetIdleThreadCount() {
+  auto lock = Synchronization::InternalLock(mx);
+  return idle;
+}
+
+void CachedThreadPoolExecutor::threadFunc() {
+  auto lock = Synchronization::InternalLock(mx);
+
+  while (true) {
+    if (tasks.Empty()) {
+      if (!running) {
+        break;
+      }
+
+      auto predicate = [this] { return !tasks.Empty() || !running; };
+
+      idle++;
+      auto woken = cv.wait_for(lock, idleTimeout, predicate);
+      idle--;
+
+      if (!woken) {
+        break;
+      }
+      continue;
+    }
+
+    auto task = tasks.PopFront();
+    lock.unlock();
+
+    try {
+      task();
+    } catch (const std::exception& ex) {
+      Logger::Error("CachedThreadPoolExecutor caught exception: {}",
+                    ex.what());
+    }
+
+    task = nullptr;
+    lock.lock();
+  }
+
+  threads--;
+  retired.emplace_back(std::this_thread::get_id());
+  finished.notify_all();
+}
+
+void CachedThreadPoolExecutor::reap(Synchronization::InternalLock& lock) {
+  std::vector<std::thread> exited;
+
+  for (auto i = std::size_t(0); i < retired.size();) {
+    auto worker = workers.find(retired[i]);
+    if (worker == workers.end()) {
+      i++;
+      continue;
+    }
+
+    exited.emplace_back(std::move(worker->second));
+    workers.erase(worker);
+    retired[i] = retired.back();
+    retired.pop_back();
+  }
+
+  lock.unlock();
+  for (auto& worker : exited) {
+    worker.join();
+  }
+  lock.lock();
+}
+}  // namespace Execution
+}  // namespace CppUtils
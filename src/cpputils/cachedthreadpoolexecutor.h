@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "executor.h"
+#include "logger.h"
+#include "profiledmutex.h"
+#include "ringbuffer.h"
+
+namespace CppUtils {
+namespace Execution {
+// Reuses idle threads and starts a new one only when all are busy, up to
+// maxThreads; tasks beyond that wait in a queue. Threads idle for longer than
+// idleTimeout exit. The destructor waits until every submitted task is done.
+// Execute throws std::runtime_error if the pool has no thread and cannot
+// start one.
+class CachedThreadPoolExecutor : public Executor {
+ public:
+  CachedThreadPoolExecutor(
+      uint32_t maxThreads = 256,
+      std::chrono::milliseconds idleTimeout = std::chrono::seconds(60));
+  ~CachedThreadPoolExecutor();
+
+  void Execute(Task&& task) override;
+  uint32_t GetConcurrency() const override;
+
+  uint32_t GetThreadCount();
+  uint32_t GetIdleThreadCount();
+
+ private:
+  void threadFunc();
+  void reap(Synchronization::InternalLock& lock);
+
+ private:
+  const uint32_t maxThreads;
+  const std::chrono::milliseconds idleTimeout;
+
+  bool running;
+  uint32_t threads;
+  uint32_t idle;
+  RingBuffer<Task> tasks;
+
+  // Threads that exited on idle timeout are joined by the next Execute that
+  // starts a thread, or by the destructor.
+  std::unordered_map<std::thread::id, std::thread> workers;
+  std::vector<std::thread::id> retired;
+
+  Synchronization::InternalMutex mx{"CachedThreadPoolExecutor::mx"};
+  Synchronization::InternalConditionVariable cv;
+  Synchronization::InternalConditionVariable finished;
+};
+}  // namespace Execution
+}  // namespace CppUtils
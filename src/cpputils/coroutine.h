@@ -0,0 +1,266 @@
+#pragma once
+#if !defined(__cpp_impl_coroutine)
+#error "coroutine.h needs C++20; link the cpputils-coroutines target"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "countdownlatch.h"
+#include "executor.h"
+#include "future.h"
+
+namespace CppUtils {
+namespace Coroutines {
+template <typename T>
+class Task;
+
+namespace Detail {
+// Hands the thread straight to the awaiting coroutine, so long chains of
+// awaits neither grow the stack nor go through an executor.
+struct FinalAwaiter {
+  bool await_ready() noexcept { return false; }
+
+  template <typename Promise>
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<Promise> handle) noexcept {
+    auto continuation = handle.promise().continuation;
+    return continuation ? continuation : std::noop_coroutine();
+  }
+
+  void await_resume() noexcept {}
+};
+
+template <typename T>
+class TaskPromiseBase {
+ public:
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() noexcept { error = std::current_exception(); }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr error;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase<T> {
+ public:
+  Task<T> get_return_object() noexcept;
+
+  template <typename U>
+  void return_value(U&& result) {
+    value.emplace(std::forward<U>(result));
+  }
+
+  T Result() {
+    if (this->error) {
+      std::rethrow_exception(this->error);
+    }
+    return std::move(*value);
+  }
+
+ private:
+  std::optional<T> value;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase<void> {
+ public:
+  Task<void> get_return_object() noexcept;
+
+  void return_void() noexcept {}
+
+  void Result() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+// A fire-and-forget coroutine whose frame frees itself when it finishes.
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+}  // namespace Detail
+
+// A lazily started coroutine producing a T. It runs once awaited, on the
+// awaiting thread, and resumes its awaiter when it finishes; exceptions
+// propagate to the awaiter. Use Spawn() to start one from plain code.
+template <typename T = void>
+class Task {
+ public:
+  using promise_type = Detail::TaskPromise<T>;
+
+  Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      reset();
+      handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() { reset(); }
+
+  auto operator co_await() noexcept {
+    struct Awaiter {
+      bool await_ready() noexcept { return !handle || handle.done(); }
+
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+
+      T await_resume() {
+        if (!handle) {
+          throw std::runtime_error("task has no coroutine");
+        }
+        return handle.promise().Result();
+      }
+
+      std::coroutine_handle<promise_type> handle;
+    };
+    return Awaiter{handle};
+  }
+
+ private:
+  explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+      : handle(handle) {}
+
+  void reset() noexcept {
+    if (handle) {
+      handle.destroy();
+      handle = {};
+    }
+  }
+
+ private:
+  std::coroutine_handle<promise_type> handle;
+
+  friend class Detail::TaskPromise<T>;
+};
+
+namespace Detail {
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>(
+      std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+template <typename T>
+Detached Run(Execution::Executor& executor, Task<T> task,
+             Execution::Promise<T> promise) {
+  try {
+    co_await executor.Schedule();
+    if constexpr (std::is_void_v<T>) {
+      co_await task;
+      promise.SetValue();
+    } else {
+      promise.SetValue(co_await task);
+    }
+  } catch (...) {
+    promise.SetException(std::current_exception());
+  }
+}
+}  // namespace Detail
+
+// Starts the task on the executor and returns the future of its result, the
+// bridge from plain code (or a blocking Get() in main) into coroutines.
+template <typename T>
+Execution::Future<T> Spawn(Execution::Executor& executor, Task<T> task) {
+  auto promise = Execution::Promise<T>(&executor);
+  auto future = promise.GetFuture();
+
+  Detail::Run(executor, std::move(task), promise);
+  return future;
+}
+}  // namespace Coroutines
+
+namespace Execution {
+// Suspends until the future is satisfied, then resumes on the future's
+// executor (or on the satisfying thread if it has none, or if the executor
+// turns the resumption away) and returns its value or rethrows its error.
+template <typename T>
+class FutureAwaiter {
+ public:
+  explicit FutureAwaiter(const Future<T>& future) : state(future.getState()) {}
+
+  bool await_ready() { return state->IsReady(); }
+
+  // Returns false to resume right away when the future became ready after
+  // await_ready, instead of resuming inline and deepening the stack.
+  bool await_suspend(std::coroutine_handle<> handle) {
+    auto resume = Task([executor = state->executor, handle] {
+      if (executor) {
+        try {
+          executor->Execute([handle] { handle.resume(); });
+          return;
+        } catch (const std::runtime_error&) {
+        }
+      }
+      handle.resume();
+    });
+    return state->AddCallback(resume);
+  }
+
+  T await_resume() {
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+      return *state->value;
+    }
+  }
+
+ private:
+  std::shared_ptr<FutureState<T>> state;
+};
+
+template <typename T>
+FutureAwaiter<T> operator co_await(const Future<T>& future) {
+  return FutureAwaiter<T>(future);
+}
+}  // namespace Execution
+
+namespace Synchronization {
+// Suspends until the latch opens; the coroutine resumes on the thread whose
+// CountDown() opened it, so hop to an executor with co_await
+// executor.Schedule() before doing real work.
+inline auto operator co_await(CountDownLatch& latch) {
+  struct Awaiter {
+    bool await_ready() { return latch.TryAwait(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      auto resume = std::function<void()>([handle] { handle.resume(); });
+      return latch.AddCallback(resume);
+    }
+
+    void await_resume() noexcept {}
+
+    CountDownLatch& latch;
+  };
+  return Awaiter{latch};
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -2,24 +2,115 @@
 
 namespace CppUtils {
 namespace Synchronization {
-CountDownLatch::CountDownLatch(uint64_t size) : size(size), completed(0ull) {}
+CountDownLatch::CountDownLatch(uint64_t size)
+    : size(size),
+      remaining(static_cast<int64_t>(size)),
+      state(size == 0 ? OPEN : 0) {}
 
 void CountDownLatch::Await() {
-  auto predicate = [this] { return size == completed; };
-  auto lock = std::unique_lock<std::mutex>(mx);
+  await([this](uint32_t expected) {
+    AtomicWait(state, expected);
+    return true;
+  });
+}
+
+bool CountDownLatch::AwaitUntil(
+    std::chrono::steady_clock::time_point deadline) {
+  return await([this, deadline](uint32_t expected) {
+    return AtomicWaitUntil(state, expected, deadline);
+  });
+}
+
+bool CountDownLatch::AwaitFor(std::chrono::nanoseconds timeout) {
+  return AwaitUntil(std::chrono::steady_clock::now() + timeout);
+}
 
-  cv.wait(lock, predicate);
+bool CountDownLatch::TryAwait() const {
+  return (state.load(std::memory_order_acquire) & OPEN) != 0;
 }
 
 void CountDownLatch::CountDown() {
-  auto lock = std::unique_lock<std::mutex>(mx);
-  completed++;
-  cv.notify_one();
+  if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    open();
+  }
 }
 
 void CountDownLatch::Reset() {
-  auto lock = std::unique_lock<std::mutex>(mx);
-  completed = 0;
+  remaining.store(static_cast<int64_t>(size), std::memory_order_relaxed);
+  if (size == 0) {
+    return;
+  }
+
+  auto current = state.load(std::memory_order_relaxed);
+  while ((current & OPEN) &&
+         !state.compare_exchange_weak(
+             current, (current & ~OPEN) + GENERATION,
+             std::memory_order_acq_rel, std::memory_order_relaxed)) {
+  }
+}
+
+void CountDownLatch::OnReady(std::function<void()> callback) {
+  if (!AddCallback(callback)) {
+    callback();
+  }
+}
+
+bool CountDownLatch::AddCallback(std::function<void()>& callback) {
+  auto lock = InternalLock(mx);
+
+  auto current = state.load(std::memory_order_acquire);
+  while (!(current & OPEN) &&
+         !state.compare_exchange_weak(current, current | CALLBACKS,
+                                      std::memory_order_acq_rel)) {
+  }
+  if (current & OPEN) {
+    return false;
+  }
+  callbacks.emplace_back(std::move(callback));
+  return true;
+}
+
+template <typename Wait>
+bool CountDownLatch::await(Wait&& wait) {
+  auto current = state.load(std::memory_order_acquire);
+  auto generation = current / GENERATION;
+
+  while (!(current & OPEN) && current / GENERATION == generation) {
+    if (!(current & WAITERS) &&
+        !state.compare_exchange_weak(current, current | WAITERS,
+                                     std::memory_order_acq_rel)) {
+      continue;
+    }
+    if (!wait(current | WAITERS)) {
+      return TryAwait();
+    }
+    current = state.load(std::memory_order_acquire);
+  }
+  return true;
+}
+
+void CountDownLatch::open() {
+  auto current = state.load(std::memory_order_relaxed);
+  while (!state.compare_exchange_weak(
+      current, (current & ~(WAITERS | CALLBACKS)) | OPEN,
+      std::memory_order_acq_rel, std::memory_order_relaxed)) {
+  }
+
+  if (current & WAITERS) {
+    AtomicNotifyAll(state);
+  }
+  if (!(current & CALLBACKS)) {
+    return;
+  }
+
+  auto lock = InternalLock(mx);
+  auto pending = std::move(callbacks);
+  callbacks.clear();
+  lock.unlock();
+
+  for (auto& callback : pending) {
+    callback();
+  }
 }
 }  // namespace Synchronization
 }  // namespace CppUtils
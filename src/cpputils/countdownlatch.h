@@ -1,11 +1,21 @@
 #pragma once
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <mutex>
+#include <vector>
+
+#include "atomicwait.h"
+#include "profiledmutex.h"
 
 namespace CppUtils {
 namespace Synchronization {
-
+// Opens once CountDown() has been called size times. A count-down is one
+// atomic decrement; only the one that opens the latch touches the wait
+// word, and it enters the kernel only if somebody is parked there. Awaiting
+// an open latch is a single load. Reset closes it again for another round;
+// it must not race with CountDown().
 class CountDownLatch {
  public:
   CountDownLatch(uint64_t size);
@@ -14,12 +24,43 @@ class CountDownLatch {
   void CountDown();
   void Reset();
 
+  // Waits at most until the deadline (or for timeout); returns whether the
+  // latch opened.
+  bool AwaitUntil(std::chrono::steady_clock::time_point deadline);
+  bool AwaitFor(std::chrono::nanoseconds timeout);
+
+  // Returns whether the latch is open, without waiting.
+  bool TryAwait() const;
+
+  // Runs the callback on the thread whose CountDown() opens the latch, or
+  // right away if it is already open. Callbacks must be short.
+  void OnReady(std::function<void()> callback);
+
+  // Takes the callback and returns true, or returns false and leaves it
+  // alone if the latch is already open.
+  bool AddCallback(std::function<void()>& callback);
+
+ private:
+  // The low bits of state flag the open latch, parked waiters and pending
+  // callbacks; the rest counts Reset()s of an open latch, so a waiter that
+  // sleeps through an open-and-reset cycle still returns.
+  static constexpr uint32_t OPEN = 1;
+  static constexpr uint32_t WAITERS = 2;
+  static constexpr uint32_t CALLBACKS = 4;
+  static constexpr uint32_t GENERATION = 8;
+
+  template <typename Wait>
+  bool await(Wait&& wait);
+  void open();
+
  private:
-  uint64_t size;
-  uint64_t completed;
+  const uint64_t size;
+  // Signed, so that extra count-downs after the latch opened stay harmless.
+  std::atomic<int64_t> remaining;
+  std::atomic<uint32_t> state;
 
-  std::mutex mx;
-  std::condition_variable cv;
+  std::vector<std::function<void()>> callbacks;
+  InternalMutex mx{"CountDownLatch::mx"};
 };
 }  // namespace Synchronization
 }  // namespace CppUtils
@@ -0,0 +1,167 @@
+#include "cputopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace CppUtils {
+namespace Execution {
+namespace {
+std::string readLine(const std::string& path) {
+  std::ifstream fin(path);
+  std::string line;
+  std::getline(fin, line);
+  return line;
+}
+
+uint32_t readNumber(const std::string& path, uint32_t fallback) {
+  auto line = readLine(path);
+  try {
+    return line.empty() ? fallback : static_cast<uint32_t>(std::stoul(line));
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+}  // namespace
+
+const CpuTopology& CpuTopology::Get() {
+  static CpuTopology topology;
+  return topology;
+}
+
+CpuTopology::CpuTopology() {
+  std::vector<uint32_t> allowed;
+
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (auto cpu = 0u; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        allowed.emplace_back(cpu);
+      }
+    }
+  }
+
+  std::map<uint32_t, uint32_t> nodeByCpu;
+  auto online = readLine("/sys/devices/system/node/online");
+  for (auto node : ParseCpuList(online)) {
+    auto path = "/sys/devices/system/node/node" + std::to_string(node);
+    for (auto cpu : ParseCpuList(readLine(path + "/cpulist"))) {
+      nodeByCpu[cpu] = node;
+    }
+  }
+#endif
+
+  if (allowed.empty()) {
+    auto count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto cpu = 0u; cpu < count; cpu++) {
+      allowed.emplace_back(cpu);
+    }
+  }
+
+  std::map<uint32_t, uint32_t> denseNodes;
+  for (auto cpu : allowed) {
+    auto info = CpuInfo{cpu, 0u, 0u, cpu};
+
+#ifdef __linux__
+    auto found = nodeByCpu.find(cpu);
+    info.node = found == nodeByCpu.end() ? 0u : found->second;
+
+    auto path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    info.package = readNumber(path + "/topology/physical_package_id", 0u);
+    info.core = readNumber(path + "/topology/core_id", cpu);
+#endif
+
+    auto dense = denseNodes.emplace(info.node, denseNodes.size());
+    info.node = dense.first->second;
+    cpus.emplace_back(info);
+  }
+
+  nodes.resize(denseNodes.size());
+  for (auto& info : cpus) {
+    nodes[info.node].emplace_back(info.id);
+
+    if (nodeOfCpu.size() <= info.id) {
+      nodeOfCpu.resize(info.id + 1, 0u);
+    }
+    nodeOfCpu[info.id] = info.node;
+  }
+}
+
+const std::vector<CpuInfo>& CpuTopology::GetCpus() const { return cpus; }
+
+const std::vector<std::vector<uint32_t>>& CpuTopology::GetNodes() const {
+  return nodes;
+}
+
+uint32_t CpuTopology::GetNodeOf(uint32_t cpu) const {
+  return cpu < nodeOfCpu.size() ? nodeOfCpu[cpu] : 0u;
+}
+
+uint32_t CpuTopology::GetCurrentNode() const {
+  if (nodes.size() < 2) {
+    return 0u;
+  }
+
+#ifdef __linux__
+  auto cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return GetNodeOf(static_cast<uint32_t>(cpu));
+  }
+#endif
+  return 0u;
+}
+
+bool CpuTopology::Pin(const std::vector<uint32_t>& cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+std::vector<uint32_t> CpuTopology::ParseCpuList(const std::string& list) {
+  std::vector<uint32_t> cpus;
+  std::stringstream stream(list);
+  std::string range;
+
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+
+    try {
+      auto dash = range.find('-');
+      auto first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+      auto last = first;
+      if (dash != std::string::npos) {
+        last = static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+      }
+
+      for (auto cpu = first; cpu <= last; cpu++) {
+        cpus.emplace_back(cpu);
+      }
+    } catch (const std::exception&) {
+      throw std::runtime_error("invalid cpu list: " + list);
+    }
+  }
+  return cpus;
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CppUtils {
+namespace Execution {
+struct CpuInfo {
+  uint32_t id;
+  uint32_t node;
+  uint32_t package;
+  uint32_t core;
+};
+
+// CPUs this process may run on, with their NUMA node (densely renumbered from
+// 0), socket and physical core, read once from /sys on Linux. Elsewhere every
+// CPU is reported on node 0 and pinning is a no-op.
+class CpuTopology {
+ public:
+  static const CpuTopology& Get();
+
+  const std::vector<CpuInfo>& GetCpus() const;
+  const std::vector<std::vector<uint32_t>>& GetNodes() const;
+  uint32_t GetNodeOf(uint32_t cpu) const;
+
+  // The node of the CPU the calling thread is running on right now.
+  uint32_t GetCurrentNode() const;
+
+  // Restricts the calling thread to the given CPUs.
+  static bool Pin(const std::vector<uint32_t>& cpus);
+
+  // Parses kernel CPU lists such as "0-3,8,10-11".
+  static std::vector<uint32_t> ParseCpuList(const std::string& list);
+
+ private:
+  CpuTopology();
+
+ private:
+  std::vector<CpuInfo> cpus;
+  std::vector<std::vector<uint32_t>> nodes;
+  std::vector<uint32_t> nodeOfCpu;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,74 @@
+#include "cyclicbarrier.h"
+
+#include <stdexcept>
+
+namespace CppUtils {
+namespace Synchronization {
+namespace {
+constexpr uint32_t SPIN_ROUNDS = 256;
+}
+
+CyclicBarrier::CyclicBarrier(uint32_t parties,
+                             std::function<void()> completion)
+    : parties(parties),
+      completion(std::move(completion)),
+      arrived(0u),
+      generation(0u) {
+  if (parties == 0) {
+    throw std::runtime_error("invalid number of parties");
+  }
+}
+
+bool CyclicBarrier::Await() {
+  // The generation cannot advance before this party arrives.
+  auto current = generation.load(std::memory_order_acquire);
+
+  if (arrived.fetch_add(1u, std::memory_order_acq_rel) + 1u < parties) {
+    wait(current);
+    return false;
+  }
+
+  // Nobody arrives for the next round before the release below.
+  arrived.store(0u, std::memory_order_relaxed);
+  if (completion) {
+    try {
+      completion();
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+  release();
+  return true;
+}
+
+uint32_t CyclicBarrier::GetParties() const { return parties; }
+
+uint32_t CyclicBarrier::GetGeneration() const {
+  return generation.load(std::memory_order_acquire);
+}
+
+void CyclicBarrier::release() {
+  generation.fetch_add(1u);
+  released.NotifyAll();
+}
+
+void CyclicBarrier::wait(uint32_t current) {
+  for (auto i = uint32_t(0); i < SPIN_ROUNDS; i++) {
+    if (generation.load(std::memory_order_acquire) != current) {
+      return;
+    }
+    CpuRelax();
+  }
+
+  while (generation.load() == current) {
+    auto key = released.PrepareWait();
+    if (generation.load() != current) {
+      released.CancelWait();
+      return;
+    }
+    released.Wait(key);
+  }
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
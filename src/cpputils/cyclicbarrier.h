@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "eventcount.h"
+
+namespace CppUtils {
+namespace Synchronization {
+// Lets a fixed number of parties wait for each other, round after round. An
+// arrival is one atomic increment; the last one of a round runs the
+// completion, resets the count and advances the generation, which releases
+// the others (sense reversal with a counter instead of a flag). Waiters spin
+// briefly on the generation before they park, so tight iterative phases
+// rarely enter the kernel.
+class CyclicBarrier {
+ public:
+  CyclicBarrier(uint32_t parties, std::function<void()> completion = nullptr);
+
+  // Blocks until all parties have arrived. Returns true on the thread whose
+  // arrival completed the round, after it ran the completion. If the
+  // completion throws, the round is still released and the exception
+  // propagates from that thread's Await().
+  bool Await();
+
+  uint32_t GetParties() const;
+
+  // Rounds completed so far; wraps around.
+  uint32_t GetGeneration() const;
+
+  CyclicBarrier(const CyclicBarrier&) = delete;
+  CyclicBarrier& operator=(const CyclicBarrier&) = delete;
+
+ private:
+  void release();
+  void wait(uint32_t current);
+
+ private:
+  const uint32_t parties;
+  const std::function<void()> completion;
+
+  alignas(64) std::atomic<uint32_t> arrived;
+  alignas(64) std::atomic<uint32_t> generation;
+  EventCount released;
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
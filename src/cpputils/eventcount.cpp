@@ -0,0 +1,41 @@
+#include "eventcount.h"
+
+namespace CppUtils {
+namespace Synchronization {
+EventCount::EventCount() : epoch(0u), waiters(0u) {}
+
+// Both sides use sequentially consistent operations: either the notifier
+// sees the waiter registered, or the waiter's recheck sees the change.
+uint32_t EventCount::PrepareWait() {
+  waiters.fetch_add(1u);
+  return epoch.load();
+}
+
+void EventCount::CancelWait() { waiters.fetch_sub(1u); }
+
+void EventCount::Wait(uint32_t key) {
+  while (epoch.load() == key) {
+    AtomicWait(epoch, key);
+  }
+  waiters.fetch_sub(1u);
+}
+
+void EventCount::NotifyOne() {
+  if (waiters.load() == 0u) {
+    return;
+  }
+  epoch.fetch_add(1u);
+  AtomicNotifyOne(epoch);
+}
+
+void EventCount::NotifyAll() {
+  if (waiters.load() == 0u) {
+    return;
+  }
+  epoch.fetch_add(1u);
+  AtomicNotifyAll(epoch);
+}
+
+uint32_t EventCount::GetWaiterCount() const { return waiters.load(); }
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "atomicwait.h"
+
+namespace CppUtils {
+namespace Synchronization {
+// Lets threads sleep until a condition they poll without a lock may have
+// changed. A waiter announces itself, rechecks the condition and only then
+// blocks; a notifier changes the condition first and pays nothing unless
+// somebody waits:
+//
+//   auto key = events.PrepareWait();
+//   if (ready()) {
+//     events.CancelWait();
+//   } else {
+//     events.Wait(key);
+//   }
+//
+// NotifyOne wakes exactly one blocked waiter.
+class EventCount {
+ public:
+  EventCount();
+
+  uint32_t PrepareWait();
+  void CancelWait();
+  void Wait(uint32_t key);
+
+  void NotifyOne();
+  void NotifyAll();
+
+  // Threads between PrepareWait and the end of Wait or CancelWait.
+  uint32_t GetWaiterCount() const;
+
+ private:
+  std::atomic<uint32_t> epoch;
+  std::atomic<uint32_t> waiters;
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
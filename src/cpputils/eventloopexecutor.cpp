@@ -0,0 +1,351 @@
+#include "eventloopexecutor.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "logger.h"
+
+namespace CppUtils {
+namespace Execution {
+struct LoopTimer : TimerNode {
+  Task task;
+  uint64_t period = 0;
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> finished{false};
+
+  // Keeps the timer alive while the wheel holds it.
+  std::shared_ptr<LoopTimer> self;
+};
+
+namespace {
+// Tasks run per loop iteration before I/O is polled again, so a task that
+// keeps resubmitting itself cannot starve the descriptors.
+constexpr std::size_t MAX_BATCH = 1024;
+constexpr int MAX_EVENTS = 64;
+
+void runGuarded(Task& task, const char* what) {
+  try {
+    task();
+  } catch (const std::exception& ex) {
+    Logger::Error("EventLoopExecutor caught exception in {}: {}", what,
+                  ex.what());
+  }
+}
+}  // namespace
+
+EventLoopTimer::EventLoopTimer(std::shared_ptr<LoopTimer> timer)
+    : timer(std::move(timer)) {}
+
+bool EventLoopTimer::Cancel() {
+  if (!timer) {
+    return false;
+  }
+  return !timer->cancelled.exchange(true) && !timer->finished;
+}
+
+bool EventLoopTimer::IsCancelled() const { return timer && timer->cancelled; }
+
+EventLoopExecutor::EventLoopExecutor(std::chrono::milliseconds resolution)
+    : resolution(std::max(resolution, std::chrono::milliseconds(1))),
+      start(Clock::now()),
+      epoll(epoll_create1(EPOLL_CLOEXEC)),
+      wakeup(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      running(true),
+      failed(false),
+      queued(0) {
+  if (epoll < 0 || wakeup < 0) {
+    if (epoll >= 0) {
+      close(epoll);
+    }
+    if (wakeup >= 0) {
+      close(wakeup);
+    }
+    throw std::runtime_error("failed to create event loop");
+  }
+
+  auto event = epoll_event();
+  event.events = EPOLLIN;
+  event.data.fd = wakeup;
+  epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &event);
+
+  thread = std::thread(&EventLoopExecutor::threadFunc, this);
+}
+
+EventLoopExecutor::~EventLoopExecutor() {
+  running = false;
+  wake();
+  thread.join();
+
+  std::vector<TimerNode*> nodes;
+  wheel.Clear(nodes);
+  for (auto* node : nodes) {
+    static_cast<LoopTimer*>(node)->self.reset();
+  }
+
+  close(wakeup);
+  close(epoll);
+}
+
+void EventLoopExecutor::Execute(Task&& task) {
+  // Counted before failed is checked: a loop that fails either drains this
+  // task or is seen here.
+  auto first = queued.fetch_add(1) == 0;
+  if (failed) {
+    queued--;
+    throw std::runtime_error("event loop has failed");
+  }
+  tasks.Push(std::move(task));
+
+  // Only the submission that finds the queue empty wakes the loop; the loop
+  // polls without blocking while the count is non-zero.
+  if (first && !IsInLoopThread()) {
+    wake();
+  }
+}
+
+uint32_t EventLoopExecutor::GetConcurrency() const { return 1; }
+
+bool EventLoopExecutor::IsInLoopThread() const {
+  return thread.get_id() == std::this_thread::get_id();
+}
+
+void EventLoopExecutor::OnReadable(int fd, std::function<void()> handler) {
+  watch(fd, false, std::move(handler));
+}
+
+void EventLoopExecutor::OnWritable(int fd, std::function<void()> handler) {
+  watch(fd, true, std::move(handler));
+}
+
+void EventLoopExecutor::Remove(int fd) {
+  auto lock = Synchronization::InternalLock(watchMx);
+  if (watches.erase(fd) > 0) {
+    epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+  }
+}
+
+EventLoopTimer EventLoopExecutor::Schedule(std::chrono::milliseconds delay,
+                                           Task&& task) {
+  return schedule(delay, std::chrono::milliseconds(0), std::move(task));
+}
+
+EventLoopTimer EventLoopExecutor::ScheduleAtFixedRate(
+    std::chrono::milliseconds initialDelay, std::chrono::milliseconds period,
+    Task&& task) {
+  if (period.count() <= 0) {
+    throw std::runtime_error("invalid period");
+  }
+  return schedule(initialDelay, period, std::move(task));
+}
+
+void EventLoopExecutor::threadFunc() {
+  epoll_event events[MAX_EVENTS];
+
+  while (running) {
+    auto count = epoll_wait(epoll, events, MAX_EVENTS, timeout());
+    if (count < 0 && errno != EINTR) {
+      Logger::Error("EventLoopExecutor: epoll_wait failed: {}", errno);
+      failed = true;
+      break;
+    }
+
+    for (auto i = 0; i < count; i++) {
+      if (events[i].data.fd == wakeup) {
+        uint64_t value;
+        while (read(wakeup, &value, sizeof(value)) > 0) {
+        }
+        continue;
+      }
+      dispatch(events[i].data.fd, events[i].events);
+    }
+
+    runTasks();
+    runTimers();
+  }
+
+  while (queued > 0) {
+    runTasks();
+  }
+}
+
+void EventLoopExecutor::watch(int fd, bool writable,
+                              std::function<void()> handler) {
+  auto lock = Synchronization::InternalLock(watchMx);
+  auto found = watches.find(fd);
+  auto registered = found != watches.end();
+
+  auto updated = registered ? found->second : Watch();
+  auto& slot = writable ? updated.writable : updated.readable;
+  slot = handler ? std::make_shared<std::function<void()>>(std::move(handler))
+                 : nullptr;
+
+  if (!updated.readable && !updated.writable) {
+    if (registered) {
+      epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+      watches.erase(found);
+    }
+    return;
+  }
+
+  auto event = epoll_event();
+  event.events = (updated.readable ? EPOLLIN : 0u) |
+                 (updated.writable ? EPOLLOUT : 0u);
+  event.data.fd = fd;
+  if (epoll_ctl(epoll, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd,
+                &event) != 0) {
+    throw std::runtime_error("failed to watch file descriptor");
+  }
+
+  watches[fd] = std::move(updated);
+}
+
+void EventLoopExecutor::dispatch(int fd, uint32_t events) {
+  auto failed = (events & (EPOLLERR | EPOLLHUP)) != 0;
+
+  // Handlers are looked up again for each kind of readiness: the readable
+  // one may have removed or replaced the writable one.
+  auto handlerOf = [&](bool writable) {
+    auto lock = Synchronization::InternalLock(watchMx);
+    auto found = watches.find(fd);
+    if (found == watches.end()) {
+      return std::shared_ptr<std::function<void()>>();
+    }
+    return writable ? found->second.writable : found->second.readable;
+  };
+
+  for (auto writable : {false, true}) {
+    auto ready = (events & (writable ? EPOLLOUT : EPOLLIN)) != 0 || failed;
+    if (!ready) {
+      continue;
+    }
+
+    auto handler = handlerOf(writable);
+    if (!handler) {
+      continue;
+    }
+
+    try {
+      (*handler)();
+    } catch (const std::exception& ex) {
+      Logger::Error("EventLoopExecutor caught exception in handler: {}",
+                    ex.what());
+    }
+  }
+}
+
+void EventLoopExecutor::runTasks() {
+  auto count = std::min(queued.load(), MAX_BATCH);
+
+  for (auto i = std::size_t(0); i < count; i++) {
+    auto task = Task();
+    if (!tasks.TryPop(task)) {
+      // A submission is still linking its node; the loop polls again.
+      return;
+    }
+    queued--;
+    runGuarded(task, "task");
+  }
+}
+
+void EventLoopExecutor::runTimers() {
+  if (wheel.Size() == 0) {
+    return;
+  }
+
+  std::vector<TimerNode*> expired;
+  wheel.Advance(ticksOf(Clock::now()), expired);
+
+  for (auto* node : expired) {
+    auto* timer = static_cast<LoopTimer*>(node);
+    auto self = std::move(timer->self);
+    if (timer->cancelled) {
+      continue;
+    }
+
+    runGuarded(timer->task, "timer");
+
+    if (timer->period == 0 || timer->cancelled) {
+      timer->finished = true;
+      continue;
+    }
+    // A run that fell behind restarts the schedule rather than replaying
+    // the missed deadlines back to back.
+    auto now = ticksOf(Clock::now());
+    timer->deadline += timer->period;
+    if (timer->deadline <= now) {
+      timer->deadline = now + timer->period;
+    }
+    insert(std::move(self));
+  }
+}
+
+int EventLoopExecutor::timeout() const {
+  if (queued > 0) {
+    return 0;
+  }
+  if (wheel.Size() == 0) {
+    return -1;
+  }
+
+  auto next = start + resolution * wheel.NextTick();
+  auto remaining = next - Clock::now();
+  if (remaining <= Clock::duration::zero()) {
+    return 0;
+  }
+
+  // Rounded up, so the loop never wakes just before the deadline.
+  auto millis = std::chrono::ceil<std::chrono::milliseconds>(remaining);
+  return static_cast<int>(
+      std::min<int64_t>(millis.count(), std::numeric_limits<int>::max()));
+}
+
+void EventLoopExecutor::wake() {
+  uint64_t one = 1;
+  while (write(wakeup, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+}
+
+EventLoopTimer EventLoopExecutor::schedule(std::chrono::milliseconds delay,
+                                           std::chrono::milliseconds period,
+                                           Task&& task) {
+  auto timer = std::make_shared<LoopTimer>();
+  timer->task = std::move(task);
+  timer->deadline =
+      ticksOf(Clock::now() + std::max(delay, std::chrono::milliseconds(0)));
+  if (period.count() > 0) {
+    timer->period = std::max<uint64_t>(
+        static_cast<uint64_t>(period / resolution), 1);
+  }
+
+  if (IsInLoopThread()) {
+    insert(timer);
+  } else {
+    Execute([this, timer] { insert(timer); });
+  }
+  return EventLoopTimer(timer);
+}
+
+void EventLoopExecutor::insert(std::shared_ptr<LoopTimer> timer) {
+  if (timer->cancelled) {
+    return;
+  }
+  if (wheel.Size() == 0) {
+    wheel.Reset(ticksOf(Clock::now()));
+  }
+
+  timer->self = timer;
+  wheel.Insert(timer.get());
+}
+
+uint64_t EventLoopExecutor::ticksOf(Clock::time_point time) const {
+  return static_cast<uint64_t>((time - start) / resolution);
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "executor.h"
+#include "mpscqueue.h"
+#include "profiledmutex.h"
+#include "timerwheel.h"
+
+namespace CppUtils {
+namespace Execution {
+struct LoopTimer;
+
+class EventLoopTimer {
+ public:
+  EventLoopTimer() = default;
+
+  // Prevents every run that has not started yet. Returns false if there was
+  // nothing left to prevent. The loop releases the timer at its next
+  // deadline.
+  bool Cancel();
+  bool IsCancelled() const;
+
+ private:
+  EventLoopTimer(std::shared_ptr<LoopTimer> timer);
+
+  std::shared_ptr<LoopTimer> timer;
+
+  friend class EventLoopExecutor;
+};
+
+// A single thread multiplexing tasks, file descriptor readiness and timers
+// with epoll. Tasks from other threads go through a lock-free queue and
+// wake the loop through an eventfd, at most once until it drains; handlers,
+// timers and tasks all run on the loop thread, so state touched only from
+// them needs no lock, and none of them may block. Linux only.
+class EventLoopExecutor : public Executor {
+ public:
+  EventLoopExecutor(
+      std::chrono::milliseconds resolution = std::chrono::milliseconds(1));
+
+  // Runs the tasks submitted so far, then stops the loop; pending timers are
+  // dropped.
+  ~EventLoopExecutor();
+
+  // Throws std::runtime_error once the loop has stopped on an epoll failure.
+  void Execute(Task&& task) override;
+  uint32_t GetConcurrency() const override;
+
+  bool IsInLoopThread() const;
+
+  // The handler runs on the loop thread whenever fd is readable (writable),
+  // and also on errors and hang-ups, until it is replaced, cleared with
+  // nullptr or the fd is removed. Readiness is level-triggered: a handler
+  // that leaves data unread runs again. Throws std::runtime_error if epoll
+  // rejects the fd.
+  void OnReadable(int fd, std::function<void()> handler);
+  void OnWritable(int fd, std::function<void()> handler);
+
+  // Stops watching fd; call it before closing the fd. A handler that the
+  // loop has already picked up may still run once unless this is called
+  // from the loop thread.
+  void Remove(int fd);
+
+  using Executor::Schedule;
+  EventLoopTimer Schedule(std::chrono::milliseconds delay, Task&& task);
+
+  // Runs are spaced by period from the first one. A run that overruns its
+  // period delays the next one instead of overlapping with it, and the
+  // missed runs are skipped: the next comes a period after the late one.
+  EventLoopTimer ScheduleAtFixedRate(std::chrono::milliseconds initialDelay,
+                                     std::chrono::milliseconds period,
+                                     Task&& task);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Watch {
+    std::shared_ptr<std::function<void()>> readable;
+    std::shared_ptr<std::function<void()>> writable;
+  };
+
+  void threadFunc();
+  void watch(int fd, bool writable, std::function<void()> handler);
+  void dispatch(int fd, uint32_t events);
+  void runTasks();
+  void runTimers();
+  int timeout() const;
+  void wake();
+
+  EventLoopTimer schedule(std::chrono::milliseconds delay,
+                          std::chrono::milliseconds period, Task&& task);
+  void insert(std::shared_ptr<LoopTimer> timer);
+  uint64_t ticksOf(Clock::time_point time) const;
+
+ private:
+  const Clock::duration resolution;
+  const Clock::time_point start;
+
+  int epoll;
+  int wakeup;
+  std::atomic<bool> running;
+  std::atomic<bool> failed;
+  std::thread thread;
+
+  MPSCQueue<Task> tasks;
+  std::atomic<std::size_t> queued;
+
+  std::unordered_map<int, Watch> watches;
+  Synchronization::InternalMutex watchMx{"EventLoopExecutor::watchMx"};
+
+  // Only touched by the loop thread.
+  TimerWheel wheel;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -1,15 +1,52 @@
 #pragma once
-#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#include "task.h"
 
 namespace CppUtils {
 namespace Execution {
-using Task = std::function<void()>;
+template <typename T>
+class Future;
 
 class Executor {
  public:
   virtual ~Executor() = default;
 
-  virtual void Execute(const Task& task) = 0;
+  virtual void Execute(Task&& task) = 0;
+
+  // How many tasks may run at the same time; parallel algorithms split their
+  // work by it.
+  virtual uint32_t GetConcurrency() const {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  // co_await executor.Schedule() suspends the coroutine and resumes it on one
+  // of this executor's threads; see coroutine.h. Plain C++17 code can ignore
+  // it: the awaiter needs no coroutine support until it is awaited.
+  struct ScheduleAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Handle>
+    void await_suspend(Handle handle) {
+      executor->Execute([handle]() mutable { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+
+    Executor* executor;
+  };
+
+  ScheduleAwaiter Schedule() { return ScheduleAwaiter{this}; }
+
+  // Runs the function on this executor and returns the future of its result.
+  // Continuations attached with Future::Then run on this executor too.
+  template <typename F>
+  auto Submit(F&& function) -> Future<std::invoke_result_t<std::decay_t<F>>>;
 };
 }  // namespace Execution
 }  // namespace CppUtils
+
+#include "future.h"
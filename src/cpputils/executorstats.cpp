@@ -0,0 +1,158 @@
+#include "executorstats.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define CPPUTILS_STATS_TSC
+#elif defined(_M_X64)
+#include <intrin.h>
+#define CPPUTILS_STATS_TSC
+#endif
+
+namespace CppUtils {
+namespace Execution {
+namespace {
+uint64_t steadyNanos() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+#ifdef CPPUTILS_STATS_TSC
+struct ClockSample {
+  uint64_t nanos;
+  uint64_t ticks;
+};
+
+// A steady_clock reading paired with the counter value halfway through it.
+ClockSample sample() {
+  auto before = __rdtsc();
+  auto nanos = steadyNanos();
+  auto after = __rdtsc();
+  return {nanos, before + (after - before) / 2};
+}
+#endif
+
+// Measured once per process against steady_clock over a busy 20 ms window;
+// spinning rather than sleeping keeps the thread on one core throughout.
+double calibrate() {
+#ifdef CPPUTILS_STATS_TSC
+  static const auto nanosPerTick = [] {
+    constexpr auto window = uint64_t(20'000'000);
+
+    auto start = sample();
+    while (steadyNanos() - start.nanos < window) {
+    }
+    auto end = sample();
+
+    auto ticks = end.ticks - start.ticks;
+    return ticks == 0 ? 1.0
+                      : static_cast<double>(end.nanos - start.nanos) / ticks;
+  }();
+  return nanosPerTick;
+#else
+  return 1.0;
+#endif
+}
+}  // namespace
+
+ExecutorMetrics::ExecutorMetrics(std::size_t nShards, bool exclusive)
+    : exclusive(exclusive), nanosPerTick(calibrate()), since(Now()) {
+  for (auto i = std::size_t(0); i < std::max(nShards, std::size_t(1)); i++) {
+    shards.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+uint64_t ExecutorMetrics::Now() {
+#ifdef CPPUTILS_STATS_TSC
+  return __rdtsc() | 1ull;
+#else
+  return steadyNanos() | 1ull;
+#endif
+}
+
+uint64_t ExecutorMetrics::Elapsed(uint64_t from, uint64_t to) {
+  return to > from ? to - from : 0;
+}
+
+void ExecutorMetrics::RecordStart(std::size_t shard, uint64_t waitTicks) {
+  auto& counters = *shards[shard];
+  auto waitTime = static_cast<uint64_t>(waitTicks * nanosPerTick);
+
+  add(counters.started, 1ull);
+  counters.waitTime.Record(waitTime, exclusive);
+}
+
+void ExecutorMetrics::RecordFinish(std::size_t shard, uint64_t runTicks,
+                                   bool failed) {
+  auto& counters = *shards[shard];
+  auto runTime = static_cast<uint64_t>(runTicks * nanosPerTick);
+
+  add(counters.completed, 1ull);
+  add(counters.busy, runTime);
+  if (failed) {
+    add(counters.failed, 1ull);
+  }
+  counters.runTime.Record(runTime, exclusive);
+}
+
+ExecutorStats ExecutorMetrics::Snapshot(uint64_t queued,
+                                        uint32_t threads) const {
+  auto lock = Synchronization::InternalLock(mx);
+
+  auto stats = collect();
+  stats.started -= std::min(stats.started, baseline.started);
+  stats.completed -= std::min(stats.completed, baseline.completed);
+  stats.failed -= std::min(stats.failed, baseline.failed);
+  stats.busy -= std::min(stats.busy, baseline.busy);
+  stats.waitTime -= baseline.waitTime;
+  stats.runTime -= baseline.runTime;
+
+  stats.queued = queued;
+  stats.running = stats.started - std::min(stats.started, stats.completed);
+  stats.threads = threads;
+  stats.elapsed = std::chrono::nanoseconds(
+      static_cast<uint64_t>(Elapsed(since, Now()) * nanosPerTick));
+
+  auto capacity = static_cast<double>(stats.elapsed.count()) * threads;
+  if (capacity > 0.0) {
+    stats.utilization =
+        std::min(static_cast<double>(stats.busy.count()) / capacity, 1.0);
+  }
+  return stats;
+}
+
+void ExecutorMetrics::Reset() {
+  auto lock = Synchronization::InternalLock(mx);
+
+  baseline = collect();
+  since = Now();
+}
+
+void ExecutorMetrics::add(std::atomic<uint64_t>& counter, uint64_t value) {
+  if (exclusive) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  } else {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+}
+
+ExecutorStats ExecutorMetrics::collect() const {
+  auto stats = ExecutorStats();
+  auto busy = uint64_t(0);
+
+  for (auto& shard : shards) {
+    stats.started += shard->started.load(std::memory_order_relaxed);
+    stats.completed += shard->completed.load(std::memory_order_relaxed);
+    stats.failed += shard->failed.load(std::memory_order_relaxed);
+    busy += shard->busy.load(std::memory_order_relaxed);
+    shard->waitTime.AddTo(stats.waitTime);
+    shard->runTime.AddTo(stats.runTime);
+  }
+  stats.busy = std::chrono::nanoseconds(busy);
+  return stats;
+}
+}  // namespace Execution
+}  // namespace CppUtils
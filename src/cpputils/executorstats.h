@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "latencyhistogram.h"
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Execution {
+struct ExecutorStats {
+  // Tasks submitted but not started yet, and started but not finished.
+  uint64_t queued = 0;
+  uint64_t running = 0;
+
+  // Counted since construction or the last reset; completed includes failed.
+  uint64_t started = 0;
+  uint64_t completed = 0;
+  uint64_t failed = 0;
+
+  // Submissions that found a bounded queue full, by how they were handled.
+  uint64_t blocked = 0;
+  uint64_t callerRuns = 0;
+  uint64_t rejected = 0;
+  uint64_t discarded = 0;
+
+  uint32_t threads = 0;
+  std::chrono::nanoseconds elapsed{0};
+  std::chrono::nanoseconds busy{0};
+
+  // Share of elapsed * threads spent running tasks.
+  double utilization = 0.0;
+
+  // Nanoseconds from submission to start, and from start to finish.
+  HistogramSnapshot waitTime;
+  HistogramSnapshot runTime;
+};
+
+// Live counters behind ExecutorStats. Each thread records into its own shard
+// so recording touches no shared cache line; an exclusive shard is written
+// by one thread only and skips atomic read-modify-writes altogether.
+class ExecutorMetrics {
+ public:
+  ExecutorMetrics(std::size_t nShards, bool exclusive);
+
+  // Timestamp in clock ticks, never zero. On x86-64 this is the time-stamp
+  // counter, which reads several times faster than steady_clock; elsewhere
+  // ticks are steady_clock nanoseconds.
+  static uint64_t Now();
+
+  // Ticks from one timestamp to a later one. Counters on different cores
+  // may disagree slightly, so a negative difference reads as zero.
+  static uint64_t Elapsed(uint64_t from, uint64_t to);
+
+  // Durations are given in ticks and recorded in nanoseconds.
+  void RecordStart(std::size_t shard, uint64_t waitTicks);
+  void RecordFinish(std::size_t shard, uint64_t runTicks, bool failed);
+
+  ExecutorStats Snapshot(uint64_t queued, uint32_t threads) const;
+
+  // Later snapshots only count what happens from now on.
+  void Reset();
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> started{0ull};
+    std::atomic<uint64_t> completed{0ull};
+    std::atomic<uint64_t> failed{0ull};
+    std::atomic<uint64_t> busy{0ull};
+    LatencyHistogram waitTime;
+    LatencyHistogram runTime;
+  };
+
+  void add(std::atomic<uint64_t>& counter, uint64_t value);
+  ExecutorStats collect() const;
+
+ private:
+  std::vector<std::unique_ptr<Shard>> shards;
+  const bool exclusive;
+  const double nanosPerTick;
+
+  mutable Synchronization::InternalMutex mx{"ExecutorMetrics::mx"};
+  ExecutorStats baseline;
+  uint64_t since;
+};
+}  // namespace Execution
+}  // namespace CppUtils
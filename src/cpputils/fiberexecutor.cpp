@@ -0,0 +1,297 @@
+#include "fiberexecutor.h"
+
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+#include "logger.h"
+
+namespace CppUtils {
+namespace Execution {
+struct Fiber {
+  ucontext_t context;
+
+  // The worker context the fiber switches back to; set on every resume, as
+  // the fiber may continue on another worker.
+  ucontext_t* caller = nullptr;
+
+  FiberExecutor* owner = nullptr;
+  FiberExecutor::Stack stack = {};
+  Task task;
+  Task afterSwitch;
+  bool started = false;
+  bool finished = false;
+
+  // The task that was to run the fiber was dropped unrun: a fiber that has
+  // not started is discarded, a suspended one waits to be handed over again.
+  void Dropped() {
+    if (started) {
+      owner->strand(this);
+    } else {
+      owner->finish(this);
+    }
+  }
+};
+
+namespace {
+thread_local Fiber* current = nullptr;
+
+// A fiber can leave a switch on another thread than it entered it, so the
+// thread-local must be looked up again each time; out-of-line accessors keep
+// the compiler from reusing the address computed before the switch.
+__attribute__((noinline)) Fiber* getCurrent() { return current; }
+__attribute__((noinline)) void setCurrent(Fiber* fiber) { current = fiber; }
+
+// The target's reference to a fiber; a task destroyed without running it,
+// whether refused or discarded, reports the fiber as dropped.
+class FiberHandle {
+ public:
+  explicit FiberHandle(Fiber* fiber) : fiber(fiber) {}
+  FiberHandle(FiberHandle&& other) noexcept
+      : fiber(std::exchange(other.fiber, nullptr)) {}
+
+  ~FiberHandle() {
+    if (fiber) {
+      fiber->Dropped();
+    }
+  }
+
+  Fiber* Release() { return std::exchange(fiber, nullptr); }
+
+ private:
+  Fiber* fiber;
+};
+}  // namespace
+
+FiberExecutor::FiberExecutor(Executor& executor, const FiberOptions& options)
+    : executor(executor),
+      stackSize(options.stackSize),
+      pooledStacks(options.pooledStacks),
+      fibers(0),
+      hasStranded(false) {
+  if (stackSize == 0) {
+    throw std::runtime_error("invalid fiber stack size");
+  }
+}
+
+FiberExecutor::~FiberExecutor() {
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    while (fibers > 0) {
+      if (stranded.empty()) {
+        cv.wait(lock, [this] { return fibers == 0 || !stranded.empty(); });
+        continue;
+      }
+
+      lock.unlock();
+      retryStranded();
+      lock.lock();
+      if (!stranded.empty()) {
+        cv.wait_for(lock, std::chrono::milliseconds(1));
+      }
+    }
+  }
+
+  auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  for (auto& stack : stacks) {
+    munmap(static_cast<char*>(stack.memory) - page, stack.size + page);
+  }
+}
+
+void FiberExecutor::Execute(Task&& task) {
+  auto* fiber = new Fiber();
+  fiber->owner = this;
+  fiber->task = std::move(task);
+
+  try {
+    fiber->stack = allocateStack();
+  } catch (...) {
+    delete fiber;
+    throw;
+  }
+
+  getcontext(&fiber->context);
+  fiber->context.uc_stack.ss_sp = fiber->stack.memory;
+  fiber->context.uc_stack.ss_size = fiber->stack.size;
+  fiber->context.uc_link = nullptr;
+  makecontext(&fiber->context, &FiberExecutor::entry, 0);
+
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    fibers++;
+  }
+
+  retryStranded();
+  submit(fiber);
+}
+
+uint32_t FiberExecutor::GetConcurrency() const {
+  return executor.GetConcurrency();
+}
+
+std::size_t FiberExecutor::GetFiberCount() const {
+  auto lock = Synchronization::InternalLock(mx);
+  return fibers;
+}
+
+Fiber* FiberExecutor::CurrentFiber() { return getCurrent(); }
+
+void FiberExecutor::Yield() {
+  auto* fiber = getCurrent();
+  if (!fiber) {
+    return;
+  }
+  Suspend([fiber] { Resume(fiber); });
+}
+
+void FiberExecutor::Suspend(Task&& afterSwitch) {
+  auto* fiber = getCurrent();
+  if (!fiber) {
+    throw std::runtime_error("not running in a fiber");
+  }
+
+  fiber->afterSwitch = std::move(afterSwitch);
+  swapcontext(&fiber->context, fiber->caller);
+}
+
+void FiberExecutor::Resume(Fiber* fiber) {
+  try {
+    fiber->owner->submit(fiber);
+  } catch (const std::exception& ex) {
+    Logger::Warning("FiberExecutor could not resume a fiber: {}", ex.what());
+  }
+}
+
+void FiberExecutor::entry() {
+  auto* fiber = getCurrent();
+
+  try {
+    fiber->task();
+  } catch (const std::exception& ex) {
+    Logger::Error("FiberExecutor caught exception: {}", ex.what());
+  }
+
+  // Captures die on the fiber's own stack, before it is recycled.
+  fiber->task = nullptr;
+  fiber->finished = true;
+  setcontext(fiber->caller);
+}
+
+void FiberExecutor::run(Fiber* fiber) {
+  auto caller = ucontext_t();
+  fiber->caller = &caller;
+  fiber->started = true;
+
+  setCurrent(fiber);
+  swapcontext(&caller, &fiber->context);
+  setCurrent(nullptr);
+
+  // A worker is about to free up. The fiber still counts, so the executor
+  // cannot go away meanwhile.
+  fiber->owner->retryStranded();
+
+  if (fiber->finished) {
+    fiber->owner->finish(fiber);
+    return;
+  }
+
+  // Once this runs, another worker may resume the fiber at any time.
+  auto afterSwitch = std::move(fiber->afterSwitch);
+  if (afterSwitch) {
+    afterSwitch();
+  }
+}
+
+// If the target refuses, the task's handle has already dealt with the fiber.
+void FiberExecutor::submit(Fiber* fiber) {
+  executor.Execute([handle = FiberHandle(fiber)]() mutable {
+    run(handle.Release());
+  });
+}
+
+void FiberExecutor::strand(Fiber* fiber) {
+  auto lock = Synchronization::InternalLock(mx);
+  stranded.emplace_back(fiber);
+  hasStranded.store(true);
+  cv.notify_all();
+}
+
+void FiberExecutor::retryStranded() {
+  if (!hasStranded.load()) {
+    return;
+  }
+
+  std::vector<Fiber*> waiting;
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    waiting.swap(stranded);
+    hasStranded.store(false);
+  }
+
+  for (auto i = std::size_t(0); i < waiting.size(); i++) {
+    try {
+      submit(waiting[i]);
+    } catch (const std::exception&) {
+      // Still full; the refused fiber is stranded again, and so are the
+      // ones after it.
+      auto lock = Synchronization::InternalLock(mx);
+      stranded.insert(stranded.end(), waiting.begin() + i + 1, waiting.end());
+      return;
+    }
+  }
+}
+
+FiberExecutor::Stack FiberExecutor::allocateStack() {
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    if (!stacks.empty()) {
+      auto stack = stacks.back();
+      stacks.pop_back();
+      return stack;
+    }
+  }
+
+  auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  auto size = (stackSize + page - 1) / page * page;
+
+  auto* memory = mmap(nullptr, size + page, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error("failed to allocate fiber stack");
+  }
+  if (mprotect(memory, page, PROT_NONE) != 0) {
+    munmap(memory, size + page);
+    throw std::runtime_error("failed to protect fiber stack");
+  }
+
+  return Stack{static_cast<char*>(memory) + page, size};
+}
+
+void FiberExecutor::releaseStack(Stack stack) {
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    if (stacks.size() < pooledStacks) {
+      stacks.push_back(stack);
+      return;
+    }
+  }
+
+  auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  munmap(static_cast<char*>(stack.memory) - page, stack.size + page);
+}
+
+void FiberExecutor::finish(Fiber* fiber) {
+  releaseStack(fiber->stack);
+  delete fiber;
+
+  auto lock = Synchronization::InternalLock(mx);
+  if (--fibers == 0) {
+    cv.notify_all();
+  }
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "executor.h"
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Execution {
+struct Fiber;
+
+struct FiberOptions {
+  // Stacks are reserved with mmap and only touched pages take memory, so a
+  // fiber that stays shallow costs a few KB however large this is. A guard
+  // page below each stack turns an overflow into a crash instead of silent
+  // corruption.
+  std::size_t stackSize = 64 * 1024;
+
+  // Stacks of finished fibers kept for reuse.
+  std::size_t pooledStacks = 1024;
+};
+
+// Runs each task on its own fiber, a user-space thread with a small stack,
+// multiplexed onto the workers of the target executor. A fiber that blocks
+// on a FiberMutex, FiberConditionVariable or FiberLatch gives its worker
+// back and is resubmitted to the target once woken, so blocking-style code
+// can keep far more operations in flight than there are threads. Fibers may
+// continue on a different worker after blocking. Other blocking calls
+// (std::mutex, sleeps, I/O) still block the worker. The target must not run
+// tasks on the submitting thread (as CallerRuns does) and must outlive this
+// executor, whose destructor waits for every fiber to finish. A woken fiber
+// that a bounded target refuses or discards is kept and handed over again
+// at the next fiber switch, and by the destructor until it is accepted; a
+// new fiber that is refused makes Execute throw. POSIX only.
+class FiberExecutor : public Executor {
+ public:
+  FiberExecutor(Executor& executor,
+                const FiberOptions& options = FiberOptions());
+  ~FiberExecutor();
+
+  void Execute(Task&& task) override;
+  uint32_t GetConcurrency() const override;
+
+  // Fibers started and not yet finished, blocked ones included.
+  std::size_t GetFiberCount() const;
+
+  // The fiber running on this thread, or nullptr outside of fibers.
+  static Fiber* CurrentFiber();
+
+  // Lets the worker run other tasks; the current fiber is resubmitted to
+  // the target and continues later. A no-op outside of fibers.
+  static void Yield();
+
+  // Building blocks of fiber-aware primitives. Suspend switches away from
+  // the current fiber and runs afterSwitch on the worker once the fiber's
+  // context is saved, so it may release the lock that makes the fiber
+  // visible to wakers. Resume resubmits a suspended fiber to its target.
+  static void Suspend(Task&& afterSwitch);
+  static void Resume(Fiber* fiber);
+
+ private:
+  struct Stack {
+    void* memory;
+    std::size_t size;
+  };
+  friend struct Fiber;
+
+  static void entry();
+  static void run(Fiber* fiber);
+
+  void submit(Fiber* fiber);
+  void strand(Fiber* fiber);
+  void retryStranded();
+
+  Stack allocateStack();
+  void releaseStack(Stack stack);
+  void finish(Fiber* fiber);
+
+ private:
+  Executor& executor;
+  const std::size_t stackSize;
+  const std::size_t pooledStacks;
+
+  std::vector<Stack> stacks;
+  std::size_t fibers;
+
+  // Suspended fibers whose resubmission the target refused or discarded.
+  std::vector<Fiber*> stranded;
+  std::atomic<bool> hasStranded;
+
+  mutable Synchronization::InternalMutex mx{"FiberExecutor::mx"};
+  Synchronization::InternalConditionVariable cv;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,118 @@
+#include "fibersync.h"
+
+namespace CppUtils {
+namespace Synchronization {
+void FiberWaitQueue::Wait(InternalLock& lock) {
+  Waiter waiter;
+  waiter.fiber = Execution::FiberExecutor::CurrentFiber();
+  waiters.push_back(&waiter);
+
+  if (!waiter.fiber) {
+    waiter.cv.wait(lock, [&waiter] { return waiter.woken; });
+    return;
+  }
+
+  // The lock is released only once the fiber is switched out, so a notifier
+  // cannot resume it before its context is saved. It resumes only after
+  // being woken.
+  auto* mutex = lock.release();
+  Execution::FiberExecutor::Suspend([mutex] { mutex->unlock(); });
+  lock = InternalLock(*mutex);
+}
+
+bool FiberWaitQueue::NotifyOne() {
+  if (waiters.empty()) {
+    return false;
+  }
+
+  auto* waiter = waiters.front();
+  waiters.pop_front();
+  wake(waiter);
+  return true;
+}
+
+void FiberWaitQueue::NotifyAll() {
+  auto woken = std::move(waiters);
+  waiters.clear();
+
+  for (auto* waiter : woken) {
+    wake(waiter);
+  }
+}
+
+void FiberWaitQueue::wake(Waiter* waiter) {
+  // The waiter lives on the waiting stack; it cannot return before the
+  // caller releases the lock.
+  waiter->woken = true;
+  if (waiter->fiber) {
+    Execution::FiberExecutor::Resume(waiter->fiber);
+  } else {
+    waiter->cv.notify_one();
+  }
+}
+
+FiberMutex::FiberMutex() : locked(false) {}
+
+void FiberMutex::lock() {
+  auto guard = InternalLock(mx);
+  while (locked) {
+    queue.Wait(guard);
+  }
+  locked = true;
+}
+
+bool FiberMutex::try_lock() {
+  auto guard = InternalLock(mx);
+  if (locked) {
+    return false;
+  }
+  locked = true;
+  return true;
+}
+
+void FiberMutex::unlock() {
+  auto guard = InternalLock(mx);
+  locked = false;
+  queue.NotifyOne();
+}
+
+void FiberConditionVariable::Wait(std::unique_lock<FiberMutex>& lock) {
+  auto guard = InternalLock(mx);
+  lock.unlock();
+  queue.Wait(guard);
+  guard.unlock();
+  lock.lock();
+}
+
+void FiberConditionVariable::NotifyOne() {
+  auto guard = InternalLock(mx);
+  queue.NotifyOne();
+}
+
+void FiberConditionVariable::NotifyAll() {
+  auto guard = InternalLock(mx);
+  queue.NotifyAll();
+}
+
+FiberLatch::FiberLatch(uint64_t size) : size(size), completed(0ull) {}
+
+void FiberLatch::Await() {
+  auto guard = InternalLock(mx);
+  while (completed < size) {
+    queue.Wait(guard);
+  }
+}
+
+void FiberLatch::CountDown() {
+  auto guard = InternalLock(mx);
+  if (++completed == size) {
+    queue.NotifyAll();
+  }
+}
+
+void FiberLatch::Reset() {
+  auto guard = InternalLock(mx);
+  completed = 0;
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
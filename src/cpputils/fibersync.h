@@ -0,0 +1,85 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "fiberexecutor.h"
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Synchronization {
+// Waiters of the fiber-aware primitives below. A fiber parks and gives its
+// worker back; an ordinary thread blocks on a condition variable, so the
+// primitives may be shared between fibers and threads. Wait and the
+// notifications are called with lock held.
+class FiberWaitQueue {
+ public:
+  void Wait(InternalLock& lock);
+  bool NotifyOne();
+  void NotifyAll();
+
+ private:
+  struct Waiter {
+    Execution::Fiber* fiber = nullptr;
+    InternalConditionVariable cv;
+    bool woken = false;
+  };
+
+  void wake(Waiter* waiter);
+
+ private:
+  std::deque<Waiter*> waiters;
+};
+
+// Lowercase members so std::unique_lock and std::lock_guard accept it.
+class FiberMutex {
+ public:
+  FiberMutex();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+ private:
+  bool locked;
+  FiberWaitQueue queue;
+  InternalMutex mx{"FiberMutex::mx"};
+};
+
+class FiberConditionVariable {
+ public:
+  void Wait(std::unique_lock<FiberMutex>& lock);
+
+  template <typename Predicate>
+  void Wait(std::unique_lock<FiberMutex>& lock, Predicate predicate) {
+    while (!predicate()) {
+      Wait(lock);
+    }
+  }
+
+  void NotifyOne();
+  void NotifyAll();
+
+ private:
+  FiberWaitQueue queue;
+  InternalMutex mx{"FiberConditionVariable::mx"};
+};
+
+class FiberLatch {
+ public:
+  FiberLatch(uint64_t size);
+
+  void Await();
+  void CountDown();
+  void Reset();
+
+ private:
+  uint64_t size;
+  uint64_t completed;
+
+  FiberWaitQueue queue;
+  InternalMutex mx{"FiberLatch::mx"};
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
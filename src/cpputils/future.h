@@ -0,0 +1,394 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "executor.h"
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Execution {
+template <typename T>
+class FutureState {
+ public:
+  using Value = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+  FutureState(Executor* executor)
+      : executor(executor), promises(1u), ready(false) {}
+
+  void SetValue(Value result) {
+    auto lock = Synchronization::InternalLock(mx);
+    if (ready) {
+      throw std::runtime_error("future is already satisfied");
+    }
+    value.emplace(std::move(result));
+    complete(lock);
+  }
+
+  void SetException(std::exception_ptr exception) {
+    auto lock = Synchronization::InternalLock(mx);
+    if (ready) {
+      throw std::runtime_error("future is already satisfied");
+    }
+    error = exception;
+    complete(lock);
+  }
+
+  // Fails the state with broken_promise unless it is satisfied already.
+  void Abandon() {
+    auto lock = Synchronization::InternalLock(mx);
+    if (ready) {
+      return;
+    }
+    error = std::make_exception_ptr(
+        std::future_error(std::future_errc::broken_promise));
+    complete(lock);
+  }
+
+  // Runs the callback on the completing thread, or right away if the state
+  // is already satisfied. Callbacks must be short and must not throw: user
+  // code is expected to be rescheduled onto the executor from here.
+  void OnReady(Task callback) {
+    if (!AddCallback(callback)) {
+      callback();
+    }
+  }
+
+  // Takes the callback for the completing thread and returns true, or
+  // returns false and leaves it alone if the state is already satisfied.
+  bool AddCallback(Task& callback) {
+    auto lock = Synchronization::InternalLock(mx);
+    if (ready) {
+      return false;
+    }
+    callbacks.emplace_back(std::move(callback));
+    return true;
+  }
+
+  void Wait() {
+    auto lock = Synchronization::InternalLock(mx);
+    auto predicate = [this] { return ready; };
+
+    cv.wait(lock, predicate);
+  }
+
+  bool IsReady() {
+    auto lock = Synchronization::InternalLock(mx);
+    return ready;
+  }
+
+  Executor* const executor;
+  std::optional<Value> value;
+  std::exception_ptr error;
+
+  // Promise objects sharing the state; the last one abandons it.
+  std::atomic<uint32_t> promises;
+
+ private:
+  void complete(Synchronization::InternalLock& lock) {
+    ready = true;
+
+    auto pending = std::move(callbacks);
+    callbacks.clear();
+    cv.notify_all();
+    lock.unlock();
+
+    for (auto& callback : pending) {
+      callback();
+    }
+  }
+
+ private:
+  bool ready;
+  std::vector<Task> callbacks;
+
+  Synchronization::InternalMutex mx{"FutureState::mx"};
+  Synchronization::InternalConditionVariable cv;
+};
+
+template <typename T>
+class Promise;
+
+template <typename T>
+class FutureAwaiter;
+
+template <typename T, typename F>
+struct ContinuationResult {
+  using type = std::invoke_result_t<F, const T&>;
+};
+
+template <typename F>
+struct ContinuationResult<void, F> {
+  using type = std::invoke_result_t<F>;
+};
+
+template <typename T>
+class Future {
+ public:
+  Future() = default;
+
+  bool IsValid() const { return state != nullptr; }
+  bool IsReady() const { return getState()->IsReady(); }
+  void Wait() const { getState()->Wait(); }
+
+  // Blocks until the result is available; rethrows the task's exception.
+  T Get() const {
+    auto& current = getState();
+    current->Wait();
+
+    if (current->error) {
+      std::rethrow_exception(current->error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+      return *current->value;
+    }
+  }
+
+  // Schedules the function on the future's executor once the result is
+  // available and returns the future of its result. Exceptions skip the
+  // continuation and propagate to the returned future.
+  template <typename F>
+  auto Then(F&& function) const {
+    return Then(getState()->executor, std::forward<F>(function));
+  }
+
+  template <typename F>
+  auto Then(Executor& executor, F&& function) const {
+    return Then(&executor, std::forward<F>(function));
+  }
+
+ private:
+  template <typename F>
+  auto Then(Executor* executor, F&& function) const {
+    using Function = std::decay_t<F>;
+    using Result = typename ContinuationResult<T, Function>::type;
+
+    auto promise = Promise<Result>(executor);
+    auto next = promise.GetFuture();
+    auto source = getState();
+
+    source->OnReady([executor, source, promise,
+                     function = Function(std::forward<F>(function))]() mutable {
+      auto run = [source, promise, function = std::move(function)]() mutable {
+        if (source->error) {
+          promise.SetException(source->error);
+          return;
+        }
+        promise.SetResultOf([&] {
+          if constexpr (std::is_void_v<T>) {
+            return function();
+          } else {
+            return function(*source->value);
+          }
+        });
+      };
+
+      if (!executor) {
+        run();
+        return;
+      }
+
+      // A rejecting executor fails the continuation's future instead of
+      // throwing into the thread that completed the source.
+      try {
+        executor->Execute(std::move(run));
+      } catch (...) {
+        promise.SetException(std::current_exception());
+      }
+    });
+
+    return next;
+  }
+
+  const std::shared_ptr<FutureState<T>>& getState() const {
+    if (!state) {
+      throw std::runtime_error("future has no state");
+    }
+    return state;
+  }
+
+ private:
+  Future(std::shared_ptr<FutureState<T>> state) : state(std::move(state)) {}
+
+  std::shared_ptr<FutureState<T>> state;
+
+  template <typename U>
+  friend class Future;
+  friend class Promise<T>;
+  friend class FutureAwaiter<T>;
+  template <typename U>
+  friend Future<std::conditional_t<std::is_void_v<U>, void, std::vector<U>>>
+  WhenAll(const std::vector<Future<U>>& futures);
+  template <typename U>
+  friend Future<std::size_t> WhenAny(const std::vector<Future<U>>& futures);
+};
+
+// Continuations of the promise's future run on the given executor; without
+// one they run on the thread that satisfies the promise. Copies share the
+// state; once the last copy is destroyed without satisfying it, the future
+// fails with std::future_error(broken_promise) instead of blocking forever.
+template <typename T>
+class Promise {
+ public:
+  Promise(Executor* executor = nullptr)
+      : state(std::make_shared<FutureState<T>>(executor)) {}
+
+  Promise(const Promise& other) : state(other.state) {
+    if (state) {
+      state->promises.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+
+  Promise(Promise&& other) noexcept : state(std::move(other.state)) {}
+
+  Promise& operator=(Promise other) noexcept {
+    std::swap(state, other.state);
+    return *this;
+  }
+
+  ~Promise() {
+    if (state && state->promises.fetch_sub(1u, std::memory_order_acq_rel) ==
+                     1u) {
+      state->Abandon();
+    }
+  }
+
+  Future<T> GetFuture() const { return Future<T>(state); }
+
+  template <typename U = T,
+            typename = std::enable_if_t<!std::is_void_v<U>>>
+  void SetValue(U value) const {
+    state->SetValue(std::move(value));
+  }
+
+  template <typename U = T, typename = std::enable_if_t<std::is_void_v<U>>>
+  void SetValue() const {
+    state->SetValue(true);
+  }
+
+  void SetException(std::exception_ptr exception) const {
+    state->SetException(exception);
+  }
+
+  // Only exceptions of the function fail the future; a state that is
+  // already satisfied still throws.
+  template <typename F>
+  void SetResultOf(F&& function) const {
+    auto result = std::optional<typename FutureState<T>::Value>();
+    try {
+      if constexpr (std::is_void_v<T>) {
+        function();
+        result.emplace(true);
+      } else {
+        result.emplace(function());
+      }
+    } catch (...) {
+      state->SetException(std::current_exception());
+      return;
+    }
+    state->SetValue(std::move(*result));
+  }
+
+ private:
+  std::shared_ptr<FutureState<T>> state;
+};
+
+// Satisfied once every future is; fails with the first failure in order.
+template <typename T>
+Future<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> WhenAll(
+    const std::vector<Future<T>>& futures) {
+  using Result = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+  auto executor =
+      futures.empty() ? nullptr : futures.front().getState()->executor;
+  auto promise = Promise<Result>(executor);
+  auto result = promise.GetFuture();
+
+  if (futures.empty()) {
+    promise.SetResultOf([] { return Result(); });
+    return result;
+  }
+
+  auto states =
+      std::make_shared<std::vector<std::shared_ptr<FutureState<T>>>>();
+  for (auto& future : futures) {
+    states->emplace_back(future.getState());
+  }
+
+  auto remaining = std::make_shared<std::atomic<std::size_t>>(futures.size());
+  auto onReady = [states, remaining, promise] {
+    if (remaining->fetch_sub(1) != 1) {
+      return;
+    }
+
+    for (auto& state : *states) {
+      if (state->error) {
+        promise.SetException(state->error);
+        return;
+      }
+    }
+
+    promise.SetResultOf([&] {
+      if constexpr (!std::is_void_v<T>) {
+        auto values = std::vector<T>();
+        values.reserve(states->size());
+        for (auto& state : *states) {
+          values.emplace_back(*state->value);
+        }
+        return values;
+      }
+    });
+  };
+
+  for (auto& state : *states) {
+    state->OnReady(onReady);
+  }
+  return result;
+}
+
+// Satisfied with the index of the first future to complete, whether it
+// completed with a value or an exception.
+template <typename T>
+Future<std::size_t> WhenAny(const std::vector<Future<T>>& futures) {
+  if (futures.empty()) {
+    throw std::runtime_error("no futures to wait for");
+  }
+
+  auto promise = Promise<std::size_t>(futures.front().getState()->executor);
+  auto result = promise.GetFuture();
+  auto done = std::make_shared<std::atomic<bool>>(false);
+
+  for (auto i = std::size_t(0); i < futures.size(); i++) {
+    futures[i].getState()->OnReady([done, promise, i] {
+      if (!done->exchange(true)) {
+        promise.SetValue(i);
+      }
+    });
+  }
+  return result;
+}
+
+template <typename F>
+auto Executor::Submit(F&& function)
+    -> Future<std::invoke_result_t<std::decay_t<F>>> {
+  using Result = std::invoke_result_t<std::decay_t<F>>;
+
+  auto promise = Promise<Result>(this);
+  auto future = promise.GetFuture();
+
+  Execute([promise,
+           function = std::decay_t<F>(std::forward<F>(function))]() mutable {
+    promise.SetResultOf(function);
+  });
+  return future;
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,132 @@
+#include "latencyhistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace CppUtils {
+namespace Execution {
+namespace {
+void add(std::atomic<uint64_t>& counter, uint64_t value, bool exclusive) {
+  if (exclusive) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  } else {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+}
+
+uint32_t mostSignificantBit(uint64_t value) {
+#if defined(__GNUC__)
+  return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+  auto bit = 0u;
+  for (auto shift = 32u; shift > 0; shift >>= 1) {
+    if (value >> shift) {
+      value >>= shift;
+      bit += shift;
+    }
+  }
+  return bit;
+#endif
+}
+}  // namespace
+
+HistogramSnapshot::HistogramSnapshot()
+    : counts(LatencyHistogram::BUCKETS, 0ull), count(0ull), sum(0ull) {}
+
+uint64_t HistogramSnapshot::GetCount() const { return count; }
+
+double HistogramSnapshot::GetMean() const {
+  return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+uint64_t HistogramSnapshot::GetPercentile(double percentile) const {
+  if (count == 0) {
+    return 0ull;
+  }
+
+  auto rank = static_cast<uint64_t>(
+      std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count));
+  rank = std::max<uint64_t>(rank, 1ull);
+
+  auto seen = 0ull;
+  for (auto i = std::size_t(0); i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return LatencyHistogram::UpperBoundOf(i);
+    }
+  }
+  return LatencyHistogram::UpperBoundOf(counts.size() - 1);
+}
+
+HistogramSnapshot& HistogramSnapshot::operator+=(
+    const HistogramSnapshot& other) {
+  for (auto i = std::size_t(0); i < counts.size(); i++) {
+    counts[i] += other.counts[i];
+  }
+  count += other.count;
+  sum += other.sum;
+  return *this;
+}
+
+HistogramSnapshot& HistogramSnapshot::operator-=(
+    const HistogramSnapshot& other) {
+  for (auto i = std::size_t(0); i < counts.size(); i++) {
+    counts[i] -= std::min(counts[i], other.counts[i]);
+  }
+  count -= std::min(count, other.count);
+  sum -= std::min(sum, other.sum);
+  return *this;
+}
+
+LatencyHistogram::LatencyHistogram() : count(0ull), sum(0ull) {
+  for (auto& counter : counts) {
+    counter.store(0ull, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::Record(uint64_t value, bool exclusive) {
+  add(counts[IndexOf(value)], 1ull, exclusive);
+  add(count, 1ull, exclusive);
+  add(sum, value, exclusive);
+}
+
+void LatencyHistogram::AddTo(HistogramSnapshot& snapshot) const {
+  for (auto i = std::size_t(0); i < counts.size(); i++) {
+    snapshot.counts[i] += counts[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count += count.load(std::memory_order_relaxed);
+  snapshot.sum += sum.load(std::memory_order_relaxed);
+}
+
+std::size_t LatencyHistogram::IndexOf(uint64_t value) {
+  value = std::min(value, (uint64_t(1) << MAX_BITS) - 1);
+  if (value < (uint64_t(1) << SUB_BUCKET_BITS)) {
+    return static_cast<std::size_t>(value);
+  }
+
+  auto msb = mostSignificantBit(value);
+  auto group = std::size_t(msb - SUB_BUCKET_BITS + 1);
+  auto sub = (value >> (msb - SUB_BUCKET_BITS)) &
+             ((uint64_t(1) << SUB_BUCKET_BITS) - 1);
+  return (group << SUB_BUCKET_BITS) + static_cast<std::size_t>(sub);
+}
+
+uint64_t LatencyHistogram::LowerBoundOf(std::size_t index) {
+  auto group = index >> SUB_BUCKET_BITS;
+  if (group == 0) {
+    return index;
+  }
+
+  auto sub = index & ((std::size_t(1) << SUB_BUCKET_BITS) - 1);
+  return ((uint64_t(1) << SUB_BUCKET_BITS) + sub) << (group - 1);
+}
+
+uint64_t LatencyHistogram::UpperBoundOf(std::size_t index) {
+  if (index + 1 >= BUCKETS) {
+    return (uint64_t(1) << MAX_BITS) - 1;
+  }
+  return LowerBoundOf(index + 1) - 1;
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CppUtils {
+namespace Execution {
+class HistogramSnapshot {
+ public:
+  HistogramSnapshot();
+
+  uint64_t GetCount() const;
+  double GetMean() const;
+
+  // Upper bound of the bucket holding the given percentile (0..100).
+  uint64_t GetPercentile(double percentile) const;
+
+  HistogramSnapshot& operator+=(const HistogramSnapshot& other);
+  HistogramSnapshot& operator-=(const HistogramSnapshot& other);
+
+ private:
+  std::vector<uint64_t> counts;
+  uint64_t count;
+  uint64_t sum;
+
+  friend class LatencyHistogram;
+};
+
+// Log-linear histogram: values below 2^SUB_BUCKET_BITS are counted exactly,
+// every larger power of two is split into 2^SUB_BUCKET_BITS linear buckets,
+// so any value is reported within 12.5%. Values are saturated at
+// 2^MAX_BITS - 1 (about 4.9 hours in nanoseconds).
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t SUB_BUCKET_BITS = 3;
+  static constexpr uint32_t MAX_BITS = 44;
+  static constexpr std::size_t BUCKETS = std::size_t(MAX_BITS -
+                                                     SUB_BUCKET_BITS + 1)
+                                         << SUB_BUCKET_BITS;
+
+  LatencyHistogram();
+
+  // Shared histograms must be recorded atomically; a histogram written by a
+  // single thread can skip the locked read-modify-write.
+  void Record(uint64_t value, bool exclusive = false);
+
+  void AddTo(HistogramSnapshot& snapshot) const;
+
+  static std::size_t IndexOf(uint64_t value);
+  static uint64_t LowerBoundOf(std::size_t index);
+  static uint64_t UpperBoundOf(std::size_t index);
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS> counts;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,33 @@
+#include "lockedtaskqueue.h"
+
+namespace CppUtils {
+namespace Execution {
+bool LockedTaskQueue::TryPush(QueuedTask&& task) {
+  auto lock = Synchronization::InternalLock(mx);
+
+  tasks.PushBack(std::move(task));
+  return true;
+}
+
+std::size_t LockedTaskQueue::TryPushBatch(Task* batch, std::size_t count,
+                                          uint64_t enqueued) {
+  auto lock = Synchronization::InternalLock(mx);
+
+  for (auto i = std::size_t(0); i < count; i++) {
+    tasks.PushBack(QueuedTask{std::move(batch[i]), enqueued});
+  }
+  return count;
+}
+
+bool LockedTaskQueue::TryPop(QueuedTask& task) {
+  auto lock = Synchronization::InternalLock(mx);
+
+  if (tasks.Empty()) {
+    return false;
+  }
+
+  task = tasks.PopFront();
+  return true;
+}
+}  // namespace Execution
+}  // namespace CppUtils
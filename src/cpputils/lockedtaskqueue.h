@@ -0,0 +1,22 @@
+#pragma once
+#include <mutex>
+
+#include "profiledmutex.h"
+#include "ringbuffer.h"
+#include "taskqueue.h"
+
+namespace CppUtils {
+namespace Execution {
+class LockedTaskQueue : public TaskQueue {
+ public:
+  bool TryPush(QueuedTask&& task) override;
+  bool TryPop(QueuedTask& task) override;
+  std::size_t TryPushBatch(Task* batch, std::size_t count,
+                           uint64_t enqueued) override;
+
+ private:
+  RingBuffer<QueuedTask> tasks;
+  Synchronization::InternalMutex mx{"LockedTaskQueue::mx"};
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,13 @@
+#include "lockfreetaskqueue.h"
+
+namespace CppUtils {
+namespace Execution {
+LockFreeTaskQueue::LockFreeTaskQueue(std::size_t capacity) : tasks(capacity) {}
+
+bool LockFreeTaskQueue::TryPush(QueuedTask&& task) {
+  return tasks.TryPush(std::move(task));
+}
+
+bool LockFreeTaskQueue::TryPop(QueuedTask& task) { return tasks.TryPop(task); }
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,18 @@
+#pragma once
+#include "mpmcqueue.h"
+#include "taskqueue.h"
+
+namespace CppUtils {
+namespace Execution {
+class LockFreeTaskQueue : public TaskQueue {
+ public:
+  LockFreeTaskQueue(std::size_t capacity);
+
+  bool TryPush(QueuedTask&& task) override;
+  bool TryPop(QueuedTask& task) override;
+
+ private:
+  MPMCQueue<QueuedTask> tasks;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <mutex>
 
+#include "profiledmutex.h"
+
 namespace CppUtils {
 class Logger {
  public:
@@ -13,7 +15,7 @@ class Logger {
 
   static void ToggleConsole(bool enabled) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     inst.consoleLogging = enabled;
 
@@ -29,7 +31,7 @@ class Logger {
 
   static void ToggleFile(bool enabled, const std::string& fileName = {}) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     inst.fileLogging = enabled;
 
@@ -48,7 +50,7 @@ class Logger {
   template <typename... Args>
   static void Information(fmt::format_string<Args...> fmt, Args&&... args) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     if (inst.consoleLogging) {
       inst.console->info(fmt, std::forward<Args>(args)...);
@@ -64,7 +66,7 @@ class Logger {
   template <typename... Args>
   static void Debug(fmt::format_string<Args...> fmt, Args&&... args) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     if (inst.consoleLogging) {
       inst.console->debug(fmt, std::forward<Args>(args)...);
@@ -80,7 +82,7 @@ class Logger {
   template <typename... Args>
   static void Warning(fmt::format_string<Args...> fmt, Args&&... args) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     if (inst.consoleLogging) {
       inst.console->warn(fmt, std::forward<Args>(args)...);
@@ -96,7 +98,7 @@ class Logger {
   template <typename... Args>
   static void Error(fmt::format_string<Args...> fmt, Args&&... args) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     if (inst.consoleLogging) {
       inst.console->error(fmt, std::forward<Args>(args)...);
@@ -112,7 +114,7 @@ class Logger {
   template <typename... Args>
   static void Critical(fmt::format_string<Args...> fmt, Args&&... args) {
     auto& inst = getInstance();
-    auto lock = std::unique_lock<std::mutex>(inst.mx);
+    auto lock = Synchronization::InternalLock(inst.mx);
 
     if (inst.consoleLogging) {
       inst.console->critical(fmt, std::forward<Args>(args)...);
@@ -135,7 +137,7 @@ class Logger {
   static const char LOGGER_CONSOLE[];
   static const char LOGGER_FILE[];
 
-  std::mutex mx;
+  Synchronization::InternalMutex mx{"Logger::mx"};
 
   bool consoleLogging;
   bool fileLogging;
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace CppUtils {
+namespace Execution {
+// Bounded lock-free multi-producer/multi-consumer ring (D. Vyukov's design).
+// Every slot carries a sequence number telling whether it is ready to be
+// written or read at the current lap, so producers and consumers only
+// contend on their own index.
+template <typename T>
+class MPMCQueue {
+ public:
+  MPMCQueue(std::size_t capacity) : head(0), tail(0) {
+    if (capacity < 2) {
+      throw std::runtime_error("invalid queue capacity");
+    }
+
+    auto size = std::size_t(1);
+    while (size < capacity) {
+      size <<= 1;
+    }
+
+    slots = std::unique_ptr<Slot[]>(new Slot[size]);
+    mask = size - 1;
+
+    for (auto i = std::size_t(0); i < size; i++) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~MPMCQueue() {
+    T value;
+    while (TryPop(value)) {
+    }
+  }
+
+  MPMCQueue(const MPMCQueue&) = delete;
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+  template <typename U>
+  bool TryPush(U&& value) {
+    auto position = tail.load(std::memory_order_relaxed);
+
+    while (true) {
+      auto& slot = slots[position & mask];
+      auto sequence = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                  static_cast<std::ptrdiff_t>(position);
+
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed)) {
+          new (&slot.storage) T(std::forward<U>(value));
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool TryPop(T& value) {
+    auto position = head.load(std::memory_order_relaxed);
+
+    while (true) {
+      auto& slot = slots[position & mask];
+      auto sequence = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                  static_cast<std::ptrdiff_t>(position + 1);
+
+      if (diff == 0) {
+        if (head.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed)) {
+          auto* stored = std::launder(reinterpret_cast<T*>(&slot.storage));
+
+          value = std::move(*stored);
+          stored->~T();
+          slot.sequence.store(position + mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::size_t Capacity() const { return mask + 1; }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<std::size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+ private:
+  std::unique_ptr<Slot[]> slots;
+  std::size_t mask;
+
+  alignas(64) std::atomic<std::size_t> head;
+  alignas(64) std::atomic<std::size_t> tail;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+namespace CppUtils {
+namespace Execution {
+// Unbounded lock-free multi-producer/single-consumer queue (D. Vyukov's
+// node-based design). A push is one exchange on the head; the consumer owns
+// the tail and never contends with producers. A push that has swapped the
+// head but not linked its node yet is invisible to TryPop for a moment.
+template <typename T>
+class MPSCQueue {
+ public:
+  MPSCQueue() {
+    auto* stub = new Node();
+    head.store(stub, std::memory_order_relaxed);
+    tail = stub;
+  }
+
+  ~MPSCQueue() {
+    while (tail) {
+      auto* next = tail->next.load(std::memory_order_relaxed);
+      delete tail;
+      tail = next;
+    }
+  }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  void Push(T&& value) {
+    auto* node = new Node();
+    node->value = std::move(value);
+
+    auto* previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Must only be called by one thread at a time.
+  bool TryPop(T& value) {
+    auto* next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+      return false;
+    }
+
+    value = std::move(next->value);
+    delete tail;
+    tail = next;
+    return true;
+  }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    T value;
+  };
+
+ private:
+  std::atomic<Node*> head;
+  Node* tail;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,317 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "executor.h"
+#include "parallelloop.h"
+
+namespace CppUtils {
+namespace Parallel {
+// Parallel versions of the STL algorithms over random-access ranges. Work is
+// split into chunks of about CHUNK_BYTES of elements, so each chunk stays in
+// the per-core caches, but never fewer than a few chunks per thread. The
+// calling thread takes part and the executor's tasks help it; ranges of a
+// single chunk run serially without touching the executor. The first
+// exception thrown by a user function is rethrown to the caller.
+constexpr std::size_t CHUNK_BYTES = 16 * 1024;
+
+namespace Detail {
+// The executor's threads and the calling one.
+inline std::size_t Participants(const Execution::Executor& executor) {
+  return std::size_t(executor.GetConcurrency()) + 1;
+}
+
+template <typename T>
+std::size_t GrainOf(const Execution::Executor& executor, std::size_t size) {
+  auto cached = std::max(CHUNK_BYTES / sizeof(T), std::size_t(1));
+  auto balanced = size / (8 * Participants(executor));
+  return std::max(std::min(cached, balanced), std::size_t(1));
+}
+
+// Calls body(from, to) over disjoint chunks covering [0, size).
+template <typename F>
+void ForChunks(Execution::Executor& executor, std::size_t size,
+               std::size_t grain, F&& body) {
+  if (size == 0) {
+    return;
+  }
+  if (size <= grain) {
+    body(std::size_t(0), size);
+    return;
+  }
+
+  auto helpers = std::min(Participants(executor) - 1, size / grain);
+  auto loop = std::make_shared<Execution::ParallelLoop>(size, grain,
+                                                        helpers + 1);
+
+  // Helpers that start after the loop has finished find nothing to claim and
+  // never touch body, so it may live on this frame.
+  auto* function = &body;
+  try {
+    for (auto i = std::size_t(0); i < helpers; i++) {
+      executor.Execute([loop, function] { loop->Run(*function); });
+    }
+  } catch (const std::runtime_error&) {
+    // A bounded executor turned helpers away; this thread covers for them.
+  }
+
+  loop->Run(body);
+  loop->Wait();
+}
+
+// Splits [0, size) into equal blocks of at least grain elements, one result
+// slot per block.
+inline std::size_t BlockCount(std::size_t size, std::size_t grain) {
+  return std::max((size + grain - 1) / grain, std::size_t(1));
+}
+}  // namespace Detail
+
+template <typename Iterator, typename F>
+void ForEach(Execution::Executor& executor, Iterator first, Iterator last,
+             F&& function) {
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  auto size = static_cast<std::size_t>(last - first);
+
+  Detail::ForChunks(executor, size, Detail::GrainOf<Value>(executor, size),
+                    [first, &function](std::size_t from, std::size_t to) {
+                      for (auto it = first + from; it != first + to; ++it) {
+                        function(*it);
+                      }
+                    });
+}
+
+// reduce must be associative; partial results are combined left to right,
+// so it need not be commutative.
+template <typename Iterator, typename T, typename Combine, typename Transform>
+T TransformReduce(Execution::Executor& executor, Iterator first,
+                  Iterator last, T init, Combine reduce, Transform transform) {
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  auto size = static_cast<std::size_t>(last - first);
+  if (size == 0) {
+    return init;
+  }
+
+  auto grain = Detail::GrainOf<Value>(executor, size);
+  auto blocks = Detail::BlockCount(size, grain);
+  auto blockSize = (size + blocks - 1) / blocks;
+  blocks = (size + blockSize - 1) / blockSize;
+
+  std::vector<std::optional<T>> partials(blocks);
+  Detail::ForChunks(
+      executor, blocks, 1, [&](std::size_t from, std::size_t to) {
+        for (auto block = from; block < to; block++) {
+          auto begin = first + block * blockSize;
+          auto end = first + std::min((block + 1) * blockSize, size);
+
+          T partial = transform(*begin);
+          for (auto it = std::next(begin); it != end; ++it) {
+            partial = reduce(std::move(partial), transform(*it));
+          }
+          partials[block].emplace(std::move(partial));
+        }
+      });
+
+  for (auto& partial : partials) {
+    init = reduce(std::move(init), std::move(*partial));
+  }
+  return init;
+}
+
+template <typename Iterator, typename T, typename Combine = std::plus<>>
+T Reduce(Execution::Executor& executor, Iterator first, Iterator last, T init,
+         Combine reduce = Combine()) {
+  auto identity = [](const auto& value) -> const auto& { return value; };
+  return TransformReduce(executor, first, last, std::move(init),
+                         std::move(reduce), identity);
+}
+
+// Writes the running totals of [first, last) to out, which may be first.
+// Block totals are computed in parallel, prefixed serially, and each block
+// is then rescanned from its offset in parallel.
+template <typename Iterator, typename OutputIterator,
+          typename Operation = std::plus<>>
+OutputIterator InclusiveScan(Execution::Executor& executor, Iterator first,
+                             Iterator last, OutputIterator out,
+                             Operation operation = Operation()) {
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  auto size = static_cast<std::size_t>(last - first);
+  if (size == 0) {
+    return out;
+  }
+
+  auto grain = Detail::GrainOf<Value>(executor, size);
+  auto blocks = Detail::BlockCount(size, grain);
+  if (blocks == 1) {
+    return std::partial_sum(first, last, out, operation);
+  }
+  auto blockSize = (size + blocks - 1) / blocks;
+  blocks = (size + blockSize - 1) / blockSize;
+
+  std::vector<std::optional<Value>> totals(blocks);
+  Detail::ForChunks(
+      executor, blocks, 1, [&](std::size_t from, std::size_t to) {
+        for (auto block = from; block < to; block++) {
+          auto begin = first + block * blockSize;
+          auto end = first + std::min((block + 1) * blockSize, size);
+
+          Value total = *begin;
+          for (auto it = std::next(begin); it != end; ++it) {
+            total = operation(std::move(total), *it);
+          }
+          totals[block].emplace(std::move(total));
+        }
+      });
+
+  for (auto block = std::size_t(1); block < blocks; block++) {
+    totals[block].emplace(operation(*totals[block - 1], *totals[block]));
+  }
+
+  Detail::ForChunks(
+      executor, blocks, 1, [&](std::size_t from, std::size_t to) {
+        for (auto block = from; block < to; block++) {
+          auto offset = block * blockSize;
+          auto begin = first + offset;
+          auto end = first + std::min(offset + blockSize, size);
+          auto target = out + offset;
+
+          if (block == 0) {
+            std::partial_sum(begin, end, target, operation);
+            continue;
+          }
+
+          Value running = *totals[block - 1];
+          for (auto it = begin; it != end; ++it, ++target) {
+            running = operation(std::move(running), *it);
+            *target = running;
+          }
+        }
+      });
+
+  return out + size;
+}
+
+// Sorts a few blocks per thread in parallel, then merges pairs of runs until
+// one is left. Each merge is itself split into independent pieces by binary
+// search, so the last rounds are as parallel as the first. Not stable; needs
+// O(n) extra memory.
+template <typename Iterator, typename Compare = std::less<>>
+void Sort(Execution::Executor& executor, Iterator first, Iterator last,
+          Compare comp = Compare()) {
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  auto size = static_cast<std::size_t>(last - first);
+
+  // Fewer, larger blocks than the other algorithms use: every doubling of
+  // the block count costs one more pass over the whole range.
+  auto grain = Detail::GrainOf<Value>(executor, size);
+  auto blocks = std::min(Detail::BlockCount(size, grain),
+                         4 * Detail::Participants(executor));
+  if (blocks == 1) {
+    std::sort(first, last, comp);
+    return;
+  }
+  auto blockSize = (size + blocks - 1) / blocks;
+  blocks = (size + blockSize - 1) / blockSize;
+
+  Detail::ForChunks(executor, blocks, 1,
+                    [&](std::size_t from, std::size_t to) {
+                      for (auto block = from; block < to; block++) {
+                        std::sort(first + block * blockSize,
+                                  first + std::min((block + 1) * blockSize,
+                                                   size),
+                                  comp);
+                      }
+                    });
+
+  // Runs move between the range and the buffer on every round.
+  std::vector<Value> buffer(std::make_move_iterator(first),
+                            std::make_move_iterator(last));
+  auto inBuffer = true;
+
+  struct Piece {
+    std::size_t left, leftEnd, right, rightEnd, out;
+  };
+  std::vector<Piece> pieces;
+
+  for (auto run = blockSize; run < size; run *= 2) {
+    pieces.clear();
+
+    auto at = [&](std::size_t index) -> const Value& {
+      return inBuffer ? buffer[index] : *(first + index);
+    };
+
+    for (auto left = std::size_t(0); left < size; left += 2 * run) {
+      auto middle = std::min(left + run, size);
+      auto end = std::min(left + 2 * run, size);
+
+      // Split the left run evenly and cut the right one at the matching
+      // values, so every piece merges into its own slice of the output.
+      auto nPieces = std::max((end - left) / blockSize, std::size_t(1));
+      auto step = std::max((middle - left + nPieces - 1) / nPieces,
+                           std::size_t(1));
+      auto right = middle;
+
+      for (auto from = left; from < middle; from += step) {
+        auto to = std::min(from + step, middle);
+        auto rightEnd = end;
+        if (to < middle) {
+          auto lo = right;
+          auto hi = end;
+          while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (comp(at(mid), at(to))) {
+              lo = mid + 1;
+            } else {
+              hi = mid;
+            }
+          }
+          rightEnd = lo;
+        }
+
+        pieces.push_back({from, to, right, rightEnd, from + (right - middle)});
+        right = rightEnd;
+      }
+    }
+
+    Detail::ForChunks(
+        executor, pieces.size(), 1, [&](std::size_t from, std::size_t to) {
+          for (auto i = from; i < to; i++) {
+            auto& piece = pieces[i];
+            if (inBuffer) {
+              std::merge(std::make_move_iterator(buffer.begin() + piece.left),
+                         std::make_move_iterator(buffer.begin() +
+                                                 piece.leftEnd),
+                         std::make_move_iterator(buffer.begin() + piece.right),
+                         std::make_move_iterator(buffer.begin() +
+                                                 piece.rightEnd),
+                         first + piece.out, comp);
+            } else {
+              std::merge(std::make_move_iterator(first + piece.left),
+                         std::make_move_iterator(first + piece.leftEnd),
+                         std::make_move_iterator(first + piece.right),
+                         std::make_move_iterator(first + piece.rightEnd),
+                         buffer.begin() + piece.out, comp);
+            }
+          }
+        });
+    inBuffer = !inBuffer;
+  }
+
+  if (inBuffer) {
+    Detail::ForChunks(executor, size, grain,
+                      [&](std::size_t from, std::size_t to) {
+                        std::move(buffer.begin() + from, buffer.begin() + to,
+                                  first + from);
+                      });
+  }
+}
+}  // namespace Parallel
+}  // namespace CppUtils
@@ -0,0 +1,70 @@
+#include "parallelloop.h"
+
+#include <algorithm>
+
+namespace CppUtils {
+namespace Execution {
+ParallelLoop::ParallelLoop(std::size_t size, std::size_t grain,
+                           std::size_t participants)
+    : size(size),
+      grain(std::max(grain, std::size_t(1))),
+      divisor(2 * std::max(participants, std::size_t(1))),
+      next(0),
+      done(0),
+      finished(size == 0) {}
+
+void ParallelLoop::Wait() {
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    auto predicate = [this] { return finished; };
+
+    cv.wait(lock, predicate);
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+bool ParallelLoop::claim(std::size_t& from, std::size_t& to) {
+  auto current = next.load(std::memory_order_relaxed);
+
+  while (current < size) {
+    auto remaining = size - current;
+    auto chunk = std::min(std::max(grain, remaining / divisor), remaining);
+
+    if (next.compare_exchange_weak(current, current + chunk,
+                                   std::memory_order_relaxed)) {
+      from = current;
+      to = current + chunk;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ParallelLoop::complete(std::size_t count) {
+  if (done.fetch_add(count, std::memory_order_acq_rel) + count != size) {
+    return;
+  }
+
+  auto lock = Synchronization::InternalLock(mx);
+  finished = true;
+  cv.notify_all();
+}
+
+void ParallelLoop::fail(std::exception_ptr exception) {
+  {
+    auto lock = Synchronization::InternalLock(mx);
+    if (!error) {
+      error = exception;
+    }
+  }
+
+  auto claimed = next.exchange(size, std::memory_order_relaxed);
+  if (claimed < size) {
+    complete(size - claimed);
+  }
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Execution {
+// Index range shared by the threads of one parallel loop. Participants claim
+// guided chunks (large at first, shrinking towards the grain as the range
+// drains) so a few claims cover most of the work while the tail stays
+// balanced.
+class ParallelLoop {
+ public:
+  ParallelLoop(std::size_t size, std::size_t grain, std::size_t participants);
+
+  // Runs claimed chunks until the range is exhausted. The first exception
+  // cancels the unclaimed rest of the range and is rethrown by Wait().
+  template <typename F>
+  void Run(F& body) {
+    auto from = std::size_t(0);
+    auto to = std::size_t(0);
+
+    while (claim(from, to)) {
+      try {
+        body(from, to);
+      } catch (...) {
+        fail(std::current_exception());
+      }
+      complete(to - from);
+    }
+  }
+
+  void Wait();
+
+ private:
+  bool claim(std::size_t& from, std::size_t& to);
+  void complete(std::size_t count);
+  void fail(std::exception_ptr exception);
+
+ private:
+  const std::size_t size;
+  const std::size_t grain;
+  const std::size_t divisor;
+
+  alignas(64) std::atomic<std::size_t> next;
+  alignas(64) std::atomic<std::size_t> done;
+
+  bool finished;
+  std::exception_ptr error;
+  Synchronization::InternalMutex mx{"ParallelLoop::mx"};
+  Synchronization::InternalConditionVariable cv;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,135 @@
+#include "phaser.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace CppUtils {
+namespace Synchronization {
+namespace {
+constexpr uint32_t SPIN_ROUNDS = 256;
+constexpr uint64_t MAX_PARTIES = 0xffff;
+constexpr uint64_t ONE_PARTY = uint64_t(1) << 16;
+constexpr uint64_t ONE_ARRIVAL = 1;
+
+uint32_t phaseOf(uint64_t state) { return static_cast<uint32_t>(state >> 32); }
+
+uint64_t partiesOf(uint64_t state) { return (state >> 16) & MAX_PARTIES; }
+
+uint64_t unarrivedOf(uint64_t state) { return state & MAX_PARTIES; }
+
+uint64_t pack(uint32_t phase, uint64_t parties, uint64_t unarrived) {
+  return uint64_t(phase) << 32 | parties << 16 | unarrived;
+}
+}  // namespace
+
+Phaser::Phaser(uint32_t parties) : state(pack(0u, parties, parties)) {
+  if (parties > MAX_PARTIES) {
+    throw std::runtime_error("too many parties");
+  }
+}
+
+uint32_t Phaser::Register(uint32_t count) {
+  auto current = state.load();
+  while (true) {
+    auto parties = partiesOf(current);
+    auto unarrived = unarrivedOf(current);
+
+    // The last arrival is between its subtraction and the advance.
+    if (unarrived == 0 && parties > 0) {
+      std::this_thread::yield();
+      current = state.load();
+      continue;
+    }
+    if (parties + count > MAX_PARTIES) {
+      throw std::runtime_error("too many parties");
+    }
+
+    auto next =
+        pack(phaseOf(current), parties + count, unarrived + count);
+    if (state.compare_exchange_weak(current, next)) {
+      return phaseOf(current);
+    }
+  }
+}
+
+uint32_t Phaser::Arrive() { return arrive(ONE_ARRIVAL); }
+
+uint32_t Phaser::ArriveAndDeregister() {
+  return arrive(ONE_PARTY | ONE_ARRIVAL);
+}
+
+uint32_t Phaser::ArriveAndAwaitAdvance() {
+  return AwaitAdvance(arrive(ONE_ARRIVAL));
+}
+
+uint32_t Phaser::AwaitAdvance(uint32_t phase) {
+  for (auto i = uint32_t(0); i < SPIN_ROUNDS; i++) {
+    auto current = phaseOf(state.load(std::memory_order_acquire));
+    if (current != phase) {
+      return current;
+    }
+    CpuRelax();
+  }
+
+  while (true) {
+    auto current = phaseOf(state.load());
+    if (current != phase) {
+      return current;
+    }
+
+    auto key = advanced.PrepareWait();
+    if (phaseOf(state.load()) != phase) {
+      advanced.CancelWait();
+      continue;
+    }
+    advanced.Wait(key);
+  }
+}
+
+uint32_t Phaser::GetPhase() const { return phaseOf(state.load()); }
+
+uint32_t Phaser::GetRegisteredParties() const {
+  return static_cast<uint32_t>(partiesOf(state.load()));
+}
+
+uint32_t Phaser::GetUnarrivedParties() const {
+  return static_cast<uint32_t>(unarrivedOf(state.load()));
+}
+
+// Checked before publishing, so a failed arrival never shows a wrapped count
+// to the others.
+uint32_t Phaser::arrive(uint64_t adjustment) {
+  auto current = state.load();
+  while (true) {
+    if (unarrivedOf(current) == 0) {
+      if (partiesOf(current) == 0) {
+        throw std::runtime_error("no unarrived party");
+      }
+
+      // The last arrival is between its subtraction and the advance; this
+      // one belongs to the next phase.
+      std::this_thread::yield();
+      current = state.load();
+      continue;
+    }
+    if (state.compare_exchange_weak(current, current - adjustment)) {
+      break;
+    }
+  }
+
+  auto phase = phaseOf(current);
+  if (unarrivedOf(current) == 1) {
+    advance(phase);
+  }
+  return phase;
+}
+
+void Phaser::advance(uint32_t phase) {
+  auto current = state.load();
+  while (!state.compare_exchange_weak(
+      current, pack(phase + 1u, partiesOf(current), partiesOf(current)))) {
+  }
+  advanced.NotifyAll();
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "eventcount.h"
+
+namespace CppUtils {
+namespace Synchronization {
+// A reusable barrier whose parties may register and deregister between (and
+// during) phases, like Java's Phaser. Phase, registered and unarrived
+// parties share one 64-bit word: an arrival is a single compare-and-swap,
+// and the party that brings the unarrived count to zero advances the phase
+// and releases the waiters. Waiters spin briefly before they park. A party
+// must arrive once per phase; arriving with no party registered throws
+// std::runtime_error. At most 65535 parties.
+class Phaser {
+ public:
+  Phaser(uint32_t parties = 0);
+
+  // Adds parties to the current phase; returns that phase.
+  uint32_t Register(uint32_t count = 1);
+
+  // Arrive without waiting; return the phase arrived at.
+  uint32_t Arrive();
+  uint32_t ArriveAndDeregister();
+
+  // Arrives and waits for the others; returns the new phase.
+  uint32_t ArriveAndAwaitAdvance();
+
+  // Waits while the current phase equals phase; returns the current phase.
+  uint32_t AwaitAdvance(uint32_t phase);
+
+  uint32_t GetPhase() const;
+  uint32_t GetRegisteredParties() const;
+  uint32_t GetUnarrivedParties() const;
+
+  Phaser(const Phaser&) = delete;
+  Phaser& operator=(const Phaser&) = delete;
+
+ private:
+  uint32_t arrive(uint64_t adjustment);
+  void advance(uint32_t phase);
+
+ private:
+  // phase << 32 | parties << 16 | unarrived
+  std::atomic<uint64_t> state;
+  EventCount advanced;
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
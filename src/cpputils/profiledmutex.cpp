@@ -0,0 +1,204 @@
+#include "profiledmutex.h"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace CppUtils {
+namespace Synchronization {
+namespace {
+// Longest waits kept per name.
+constexpr std::size_t WORST_WAITS = 5;
+
+double millisOf(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+}  // namespace
+
+struct LockSite {
+  std::string name;
+
+  std::atomic<uint64_t> instances{0ull};
+  std::atomic<uint64_t> acquisitions{0ull};
+  std::atomic<uint64_t> contended{0ull};
+  std::atomic<uint64_t> waited{0ull};
+  std::atomic<uint64_t> held{0ull};
+  Execution::LatencyHistogram waitTime;
+
+  // Waits shorter than the shortest kept one, once WORST_WAITS are kept,
+  // skip the lock below.
+  std::atomic<uint64_t> worstThreshold{0ull};
+  std::mutex worstMx;
+  std::vector<LockWait> worstWaits;
+
+  // Counters at the last reset.
+  LockProfile baseline;
+
+  void RecordWait(std::chrono::nanoseconds duration) {
+    auto nanos = static_cast<uint64_t>(duration.count());
+    contended.fetch_add(1ull, std::memory_order_relaxed);
+    waited.fetch_add(nanos, std::memory_order_relaxed);
+    waitTime.Record(nanos);
+
+    if (nanos <= worstThreshold.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    auto lock = std::unique_lock<std::mutex>(worstMx);
+    worstWaits.push_back({duration, std::this_thread::get_id()});
+    std::sort(worstWaits.begin(), worstWaits.end(),
+              [](const LockWait& a, const LockWait& b) {
+                return a.duration > b.duration;
+              });
+    if (worstWaits.size() > WORST_WAITS) {
+      worstWaits.pop_back();
+    }
+    if (worstWaits.size() == WORST_WAITS) {
+      worstThreshold.store(
+          static_cast<uint64_t>(worstWaits.back().duration.count()),
+          std::memory_order_relaxed);
+    }
+  }
+};
+
+ProfiledMutex::ProfiledMutex(const std::string& name)
+    : site(LockRegistry::Get().site(name)) {
+  site->instances.fetch_add(1ull, std::memory_order_relaxed);
+}
+
+ProfiledMutex::~ProfiledMutex() {
+  site->instances.fetch_sub(1ull, std::memory_order_relaxed);
+}
+
+void ProfiledMutex::lock() {
+  if (!mx.try_lock()) {
+    auto start = Clock::now();
+    mx.lock();
+    acquired = Clock::now();
+    site->RecordWait(acquired - start);
+  } else {
+    acquired = Clock::now();
+  }
+  site->acquisitions.fetch_add(1ull, std::memory_order_relaxed);
+}
+
+bool ProfiledMutex::try_lock() {
+  if (!mx.try_lock()) {
+    return false;
+  }
+  acquired = Clock::now();
+  site->acquisitions.fetch_add(1ull, std::memory_order_relaxed);
+  return true;
+}
+
+void ProfiledMutex::unlock() {
+  auto held = Clock::now() - acquired;
+  site->held.fetch_add(
+      static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(held).count()),
+      std::memory_order_relaxed);
+  mx.unlock();
+}
+
+LockRegistry& LockRegistry::Get() {
+  static LockRegistry registry;
+  return registry;
+}
+
+std::vector<LockProfile> LockRegistry::Snapshot() const {
+  auto lock = std::unique_lock<std::mutex>(mx);
+
+  std::vector<LockProfile> profiles;
+  for (auto& entry : sites) {
+    auto& site = *entry.second;
+    auto& baseline = site.baseline;
+
+    auto profile = LockProfile();
+    profile.name = site.name;
+    profile.instances = site.instances.load(std::memory_order_relaxed);
+    profile.acquisitions =
+        site.acquisitions.load(std::memory_order_relaxed) -
+        baseline.acquisitions;
+    profile.contended =
+        site.contended.load(std::memory_order_relaxed) - baseline.contended;
+    profile.waited = std::chrono::nanoseconds(
+                         site.waited.load(std::memory_order_relaxed)) -
+                     baseline.waited;
+    profile.held =
+        std::chrono::nanoseconds(site.held.load(std::memory_order_relaxed)) -
+        baseline.held;
+    site.waitTime.AddTo(profile.waitTime);
+    profile.waitTime -= baseline.waitTime;
+    {
+      auto worstLock = std::unique_lock<std::mutex>(site.worstMx);
+      profile.worstWaits = site.worstWaits;
+    }
+    profiles.push_back(std::move(profile));
+  }
+
+  std::sort(profiles.begin(), profiles.end(),
+            [](const LockProfile& a, const LockProfile& b) {
+              return a.waited > b.waited;
+            });
+  return profiles;
+}
+
+std::string LockRegistry::Report() const {
+  auto report = fmt::format("{:<40} {:>12} {:>10} {:>12} {:>12} {:>12}\n",
+                            "lock", "acquired", "contended", "waited ms",
+                            "p99 wait us", "held ms");
+
+  for (auto& profile : Snapshot()) {
+    report += fmt::format(
+        "{:<40} {:>12} {:>9.1f}% {:>12.3f} {:>12.1f} {:>12.3f}\n",
+        profile.name, profile.acquisitions,
+        profile.acquisitions == 0
+            ? 0.0
+            : 100.0 * profile.contended / profile.acquisitions,
+        millisOf(profile.waited), profile.waitTime.GetPercentile(99) / 1e3,
+        millisOf(profile.held));
+
+    for (auto& wait : profile.worstWaits) {
+      report += fmt::format("    waited {:.3f} ms on thread {}\n",
+                            millisOf(wait.duration),
+                            std::hash<std::thread::id>()(wait.thread));
+    }
+  }
+  return report;
+}
+
+void LockRegistry::Reset() {
+  auto lock = std::unique_lock<std::mutex>(mx);
+
+  for (auto& entry : sites) {
+    auto& site = *entry.second;
+    auto& baseline = site.baseline;
+
+    baseline.acquisitions = site.acquisitions.load(std::memory_order_relaxed);
+    baseline.contended = site.contended.load(std::memory_order_relaxed);
+    baseline.waited =
+        std::chrono::nanoseconds(site.waited.load(std::memory_order_relaxed));
+    baseline.held =
+        std::chrono::nanoseconds(site.held.load(std::memory_order_relaxed));
+    baseline.waitTime = Execution::HistogramSnapshot();
+    site.waitTime.AddTo(baseline.waitTime);
+
+    auto worstLock = std::unique_lock<std::mutex>(site.worstMx);
+    site.worstWaits.clear();
+    site.worstThreshold.store(0ull, std::memory_order_relaxed);
+  }
+}
+
+std::shared_ptr<LockSite> LockRegistry::site(const std::string& name) {
+  auto lock = std::unique_lock<std::mutex>(mx);
+
+  auto& site = sites[name];
+  if (!site) {
+    site = std::make_shared<LockSite>();
+    site->name = name;
+  }
+  return site;
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
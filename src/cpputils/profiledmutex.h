@@ -0,0 +1,112 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latencyhistogram.h"
+
+namespace CppUtils {
+namespace Synchronization {
+struct LockSite;
+
+struct LockWait {
+  std::chrono::nanoseconds duration{0};
+  std::thread::id thread;
+};
+
+struct LockProfile {
+  std::string name;
+
+  // Live mutexes sharing the name.
+  uint64_t instances = 0;
+
+  // Counted since the first mutex of that name or the last reset; contended
+  // acquisitions had to wait for another holder.
+  uint64_t acquisitions = 0;
+  uint64_t contended = 0;
+  std::chrono::nanoseconds waited{0};
+  std::chrono::nanoseconds held{0};
+
+  // Nanoseconds of the contended waits, and the longest of them.
+  Execution::HistogramSnapshot waitTime;
+  std::vector<LockWait> worstWaits;
+};
+
+// A std::mutex that records, per name, how often it is taken, how long
+// threads wait for it and how long it is held. Every mutex of the same name
+// adds to one LockProfile in the LockRegistry, so all queues of a pool show
+// up as one lock. An uncontended lock costs a try_lock, two clock reads and
+// a relaxed increment more than a std::mutex. Waiting on it through
+// std::condition_variable_any releases it, so that time counts as neither
+// waited nor held.
+class ProfiledMutex {
+ public:
+  explicit ProfiledMutex(const std::string& name);
+  ~ProfiledMutex();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  ProfiledMutex(const ProfiledMutex&) = delete;
+  ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  std::mutex mx;
+  std::shared_ptr<LockSite> site;
+  Clock::time_point acquired;
+};
+
+// Profiles of every ProfiledMutex name seen by this process.
+class LockRegistry {
+ public:
+  static LockRegistry& Get();
+
+  // Sorted by time waited, longest first.
+  std::vector<LockProfile> Snapshot() const;
+
+  // One line per lock plus its worst waits, readable as is.
+  std::string Report() const;
+
+  // Later snapshots only count what happens from now on.
+  void Reset();
+
+ private:
+  LockRegistry() = default;
+
+  std::shared_ptr<LockSite> site(const std::string& name);
+
+ private:
+  mutable std::mutex mx;
+  std::map<std::string, std::shared_ptr<LockSite>> sites;
+
+  friend class ProfiledMutex;
+};
+
+// The library's own mutexes. With CPPUTILS_PROFILE_LOCKS defined (the CMake
+// option of the same name) they are ProfiledMutexes named after their
+// owner; otherwise the name is dropped and they are plain std::mutexes.
+// ProfiledMutex and LockRegistry themselves keep std::mutex, since profiling
+// them would recurse into the registry.
+#ifdef CPPUTILS_PROFILE_LOCKS
+using InternalMutex = ProfiledMutex;
+using InternalLock = std::unique_lock<ProfiledMutex>;
+using InternalConditionVariable = std::condition_variable_any;
+#else
+class InternalMutex : public std::mutex {
+ public:
+  explicit InternalMutex(const char*) {}
+};
+using InternalLock = std::unique_lock<std::mutex>;
+using InternalConditionVariable = std::condition_variable;
+#endif
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,74 @@
+#include "ratelimiter.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace CppUtils {
+namespace Synchronization {
+namespace {
+int64_t intervalOf(double permitsPerSecond) {
+  if (!(permitsPerSecond > 0.0) || permitsPerSecond > 1e9) {
+    throw std::runtime_error("invalid rate");
+  }
+  return static_cast<int64_t>(1e9 / permitsPerSecond);
+}
+}  // namespace
+
+RateLimiter::RateLimiter(double permitsPerSecond, uint32_t burst)
+    : start(Clock::now()),
+      interval(intervalOf(permitsPerSecond)),
+      capacity(interval * burst),
+      full(0) {
+  if (burst == 0) {
+    throw std::runtime_error("invalid burst");
+  }
+}
+
+// Taking count permits moves the full time count intervals further out;
+// they are available while that stays within one bucket of now.
+bool RateLimiter::TryAcquire(uint32_t count) {
+  auto time = now();
+  auto current = full.load(std::memory_order_relaxed);
+
+  while (true) {
+    auto next = std::max(current, time) + interval * count;
+    if (next - time > capacity) {
+      return false;
+    }
+    if (full.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+void RateLimiter::Acquire(uint32_t count) {
+  auto time = now();
+  auto current = full.load(std::memory_order_relaxed);
+  auto next = int64_t(0);
+
+  do {
+    next = std::max(current, time) + interval * count;
+  } while (
+      !full.compare_exchange_weak(current, next, std::memory_order_relaxed));
+
+  auto due = next - capacity;
+  if (due > time) {
+    std::this_thread::sleep_until(start + std::chrono::nanoseconds(due));
+  }
+}
+
+uint32_t RateLimiter::GetAvailable() const {
+  auto time = now();
+  auto used = std::max(full.load(std::memory_order_relaxed), time) - time;
+  return static_cast<uint32_t>(std::max<int64_t>(capacity - used, 0) /
+                               interval);
+}
+
+int64_t RateLimiter::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                              start)
+      .count();
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
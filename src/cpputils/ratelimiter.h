@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace CppUtils {
+namespace Synchronization {
+// Token bucket refilled with permitsPerSecond and holding at most burst
+// permits, kept as the generic cell rate algorithm: the only state is the
+// time at which the bucket will be full again, updated with one
+// compare-and-swap, so there is no lock and no refill thread. Starts full.
+class RateLimiter {
+ public:
+  RateLimiter(double permitsPerSecond, uint32_t burst = 1);
+
+  // Takes count permits if all of them are available right now. A count
+  // above the burst never succeeds.
+  bool TryAcquire(uint32_t count = 1);
+
+  // Reserves count permits and sleeps until they are due. Reservations
+  // queue up: later callers wait behind the permits taken by earlier ones.
+  void Acquire(uint32_t count = 1);
+
+  uint32_t GetAvailable() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  int64_t now() const;
+
+ private:
+  const Clock::time_point start;
+  const int64_t interval;
+  const int64_t capacity;
+
+  // Nanoseconds since start at which the bucket is full.
+  std::atomic<int64_t> full;
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
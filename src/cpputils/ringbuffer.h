@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace CppUtils {
+namespace Execution {
+// Growable double-ended ring. Unlike std::deque it keeps its storage once
+// grown, so a steady stream of push/pop does not touch the allocator.
+template <typename T>
+class RingBuffer {
+ public:
+  RingBuffer(std::size_t capacity = 64) : head(0), size(0) {
+    auto initial = std::size_t(1);
+    while (initial < capacity) {
+      initial <<= 1;
+    }
+    items.resize(initial);
+  }
+
+  bool Empty() const { return size == 0; }
+  std::size_t Size() const { return size; }
+
+  void PushBack(T&& item) {
+    if (size == items.size()) {
+      grow();
+    }
+    items[(head + size) & (items.size() - 1)] = std::move(item);
+    size++;
+  }
+
+  T PopFront() {
+    auto item = std::move(items[head]);
+    head = (head + 1) & (items.size() - 1);
+    size--;
+    return item;
+  }
+
+  T PopBack() {
+    size--;
+    return std::move(items[(head + size) & (items.size() - 1)]);
+  }
+
+ private:
+  void grow() {
+    auto grown = std::vector<T>(items.size() * 2);
+    for (auto i = std::size_t(0); i < size; i++) {
+      grown[i] = std::move(items[(head + i) & (items.size() - 1)]);
+    }
+    items = std::move(grown);
+    head = 0;
+  }
+
+ private:
+  std::vector<T> items;
+  std::size_t head;
+  std::size_t size;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,267 @@
+#include "scheduledexecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Execution {
+struct SchedulerState {
+  using Clock = std::chrono::steady_clock;
+
+  SchedulerState(Executor& executor, std::chrono::milliseconds resolution)
+      : executor(executor),
+        resolution(std::max(resolution, std::chrono::milliseconds(1))),
+        start(Clock::now()),
+        running(true),
+        wakeTick(std::numeric_limits<uint64_t>::max()) {}
+
+  uint64_t TicksOf(Clock::time_point time) const {
+    return static_cast<uint64_t>((time - start) / resolution);
+  }
+
+  Executor& executor;
+  const Clock::duration resolution;
+  const Clock::time_point start;
+
+  TimerWheel wheel;
+  bool running;
+  uint64_t wakeTick;
+
+  Synchronization::InternalMutex mx{"ScheduledExecutor::mx"};
+  Synchronization::InternalConditionVariable cv;
+};
+
+struct ScheduledTimer : TimerNode {
+  Task task;
+  uint64_t period = 0;
+  std::atomic<bool> cancelled{false};
+
+  // A one-shot run and Cancel race for this; only the first one proceeds.
+  std::atomic<bool> claimed{false};
+
+  // Keeps the timer alive while the wheel holds it.
+  std::shared_ptr<ScheduledTimer> self;
+  std::weak_ptr<SchedulerState> state;
+};
+
+namespace {
+void insert(SchedulerState& state, std::shared_ptr<ScheduledTimer> timer) {
+  if (state.wheel.Size() == 0) {
+    state.wheel.Reset(state.TicksOf(SchedulerState::Clock::now()));
+  }
+
+  timer->self = timer;
+  state.wheel.Insert(timer.get());
+
+  if (timer->deadline < state.wakeTick) {
+    state.cv.notify_one();
+  }
+}
+
+// Called with the lock held.
+void rearm(SchedulerState& state, std::shared_ptr<ScheduledTimer> timer,
+           uint64_t deadline) {
+  if (state.running && !timer->cancelled) {
+    timer->deadline = deadline;
+    insert(state, std::move(timer));
+  }
+}
+
+void dispatch(SchedulerState& state, std::shared_ptr<ScheduledTimer> timer) {
+  state.executor.Execute([timer = std::move(timer)] {
+    if (timer->period == 0 ? timer->claimed.exchange(true)
+                           : timer->cancelled.load()) {
+      return;
+    }
+
+    try {
+      timer->task();
+    } catch (const std::exception& ex) {
+      Logger::Error("ScheduledExecutor caught exception: {}", ex.what());
+    }
+
+    if (timer->period == 0) {
+      return;
+    }
+
+    auto state = timer->state.lock();
+    if (!state) {
+      return;
+    }
+
+    auto lock = Synchronization::InternalLock(state->mx);
+    rearm(*state, timer, timer->deadline + timer->period);
+  });
+}
+}  // namespace
+
+ScheduledTask::ScheduledTask(std::shared_ptr<ScheduledTimer> timer)
+    : timer(std::move(timer)) {}
+
+bool ScheduledTask::Cancel() {
+  if (!timer) {
+    return false;
+  }
+
+  // A dispatched one-shot run that has not started yet is prevented too.
+  auto prevent = [this] {
+    auto wasCancelled = timer->cancelled.exchange(true);
+    return timer->period == 0 ? !timer->claimed.exchange(true)
+                              : !wasCancelled;
+  };
+
+  auto state = timer->state.lock();
+  if (!state) {
+    return prevent();
+  }
+
+  std::shared_ptr<ScheduledTimer> self;
+  auto lock = Synchronization::InternalLock(state->mx);
+  auto prevented = prevent();
+
+  if (timer->linked) {
+    state->wheel.Remove(timer.get());
+    self = std::move(timer->self);
+  }
+  lock.unlock();
+
+  return prevented;
+}
+
+bool ScheduledTask::IsCancelled() const { return timer && timer->cancelled; }
+
+ScheduledExecutor::ScheduledExecutor(Executor& executor,
+                                     std::chrono::milliseconds resolution)
+    : state(std::make_shared<SchedulerState>(executor, resolution)) {
+  timerThread = std::thread(&ScheduledExecutor::threadFunc, this);
+}
+
+ScheduledExecutor::~ScheduledExecutor() {
+  {
+    auto lock = Synchronization::InternalLock(state->mx);
+    state->running = false;
+
+    state->cv.notify_all();
+  }
+
+  timerThread.join();
+
+  std::vector<TimerNode*> nodes;
+  std::vector<std::shared_ptr<ScheduledTimer>> timers;
+  {
+    auto lock = Synchronization::InternalLock(state->mx);
+
+    state->wheel.Clear(nodes);
+    for (auto* node : nodes) {
+      timers.emplace_back(std::move(static_cast<ScheduledTimer*>(node)->self));
+    }
+  }
+}
+
+void ScheduledExecutor::Execute(Task&& task) {
+  state->executor.Execute(std::move(task));
+}
+
+uint32_t ScheduledExecutor::GetConcurrency() const {
+  return state->executor.GetConcurrency();
+}
+
+ScheduledTask ScheduledExecutor::Schedule(std::chrono::milliseconds delay,
+                                          Task&& task) {
+  return schedule(delay, std::chrono::milliseconds(0), std::move(task));
+}
+
+ScheduledTask ScheduledExecutor::ScheduleAtFixedRate(
+    std::chrono::milliseconds initialDelay, std::chrono::milliseconds period,
+    Task&& task) {
+  if (period <= std::chrono::milliseconds(0)) {
+    throw std::runtime_error("invalid period");
+  }
+  return schedule(initialDelay, period, std::move(task));
+}
+
+ScheduledTask ScheduledExecutor::schedule(std::chrono::milliseconds delay,
+                                          std::chrono::milliseconds period,
+                                          Task&& task) {
+  auto ticksOf = [this](std::chrono::milliseconds duration) {
+    auto rounding = state->resolution - SchedulerState::Clock::duration(1);
+    auto ticks = (duration + rounding) / state->resolution;
+    return static_cast<uint64_t>(std::max<decltype(ticks)>(ticks, 0));
+  };
+
+  auto timer = std::make_shared<ScheduledTimer>();
+  timer->task = std::move(task);
+  timer->period =
+      period.count() > 0 ? std::max<uint64_t>(ticksOf(period), 1) : 0;
+  timer->state = state;
+
+  auto delayTicks = ticksOf(delay);
+  if (delayTicks == 0) {
+    timer->deadline = state->TicksOf(SchedulerState::Clock::now());
+    dispatch(*state, timer);
+    return ScheduledTask(timer);
+  }
+
+  // The current tick is partly over, so counting from its end keeps the run
+  // from firing early.
+  auto lock = Synchronization::InternalLock(state->mx);
+  timer->deadline =
+      state->TicksOf(SchedulerState::Clock::now()) + delayTicks + 1;
+  insert(*state, timer);
+  return ScheduledTask(timer);
+}
+
+void ScheduledExecutor::threadFunc() {
+  auto lock = Synchronization::InternalLock(state->mx);
+
+  std::vector<TimerNode*> expired;
+  std::vector<std::shared_ptr<ScheduledTimer>> due;
+
+  while (state->running) {
+    if (state->wheel.Size() == 0) {
+      state->wakeTick = std::numeric_limits<uint64_t>::max();
+      state->cv.wait(lock);
+      continue;
+    }
+
+    state->wheel.Advance(state->TicksOf(SchedulerState::Clock::now()),
+                         expired);
+    for (auto* node : expired) {
+      due.emplace_back(std::move(static_cast<ScheduledTimer*>(node)->self));
+    }
+    expired.clear();
+
+    if (!due.empty()) {
+      lock.unlock();
+      for (auto& timer : due) {
+        try {
+          dispatch(*state, timer);
+        } catch (const std::exception& ex) {
+          Logger::Error("ScheduledExecutor could not dispatch a task: {}",
+                        ex.what());
+
+          // The refused run is skipped; a periodic task tries again a
+          // period from now.
+          if (timer->period > 0) {
+            auto retry = Synchronization::InternalLock(state->mx);
+            rearm(*state, timer,
+                  state->TicksOf(SchedulerState::Clock::now()) +
+                      timer->period);
+          }
+        }
+      }
+      due.clear();
+      lock.lock();
+      continue;
+    }
+
+    state->wakeTick = state->wheel.NextTick();
+    state->cv.wait_until(
+        lock, state->start + state->wakeTick * state->resolution);
+  }
+}
+}  // namespace Execution
+}  // namespace CppUtils
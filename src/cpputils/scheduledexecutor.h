@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "executor.h"
+#include "logger.h"
+#include "timerwheel.h"
+
+namespace CppUtils {
+namespace Execution {
+struct ScheduledTimer;
+struct SchedulerState;
+
+class ScheduledTask {
+ public:
+  ScheduledTask() = default;
+
+  // Prevents every run that has not started yet. Returns false if there was
+  // nothing left to prevent.
+  bool Cancel();
+  bool IsCancelled() const;
+
+ private:
+  ScheduledTask(std::shared_ptr<ScheduledTimer> timer);
+
+  std::shared_ptr<ScheduledTimer> timer;
+
+  friend class ScheduledExecutor;
+};
+
+// Keeps delayed and periodic tasks in a hierarchical timing wheel driven by
+// one timer thread and dispatches them onto the target executor when due,
+// so no worker sleeps while waiting. The target must outlive this executor.
+// If it refuses a due run, the run is logged and skipped; a periodic task
+// comes back a period later.
+class ScheduledExecutor : public Executor {
+ public:
+  ScheduledExecutor(
+      Executor& executor,
+      std::chrono::milliseconds resolution = std::chrono::milliseconds(1));
+  ~ScheduledExecutor();
+
+  void Execute(Task&& task) override;
+  uint32_t GetConcurrency() const override;
+
+  using Executor::Schedule;
+  ScheduledTask Schedule(std::chrono::milliseconds delay, Task&& task);
+
+  // Runs are spaced by period from the first one; a run that overruns its
+  // period delays the next one instead of overlapping with it.
+  ScheduledTask ScheduleAtFixedRate(std::chrono::milliseconds initialDelay,
+                                    std::chrono::milliseconds period,
+                                    Task&& task);
+
+ private:
+  ScheduledTask schedule(std::chrono::milliseconds delay,
+                         std::chrono::milliseconds period, Task&& task);
+  void threadFunc();
+
+ private:
+  std::shared_ptr<SchedulerState> state;
+  std::thread timerThread;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,75 @@
+#include "semaphore.h"
+
+namespace CppUtils {
+namespace Synchronization {
+Semaphore::Semaphore(uint32_t permits) : permits(permits), waiters(0u) {}
+
+void Semaphore::Acquire() {
+  acquire([this] {
+    AtomicWait(permits, 0u);
+    return true;
+  });
+}
+
+bool Semaphore::TryAcquire() {
+  auto current = permits.load(std::memory_order_relaxed);
+  while (current > 0u) {
+    if (permits.compare_exchange_weak(current, current - 1u,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Semaphore::TryAcquireUntil(
+    std::chrono::steady_clock::time_point deadline) {
+  return acquire(
+      [this, deadline] { return AtomicWaitUntil(permits, 0u, deadline); });
+}
+
+bool Semaphore::TryAcquireFor(std::chrono::nanoseconds timeout) {
+  return TryAcquireUntil(std::chrono::steady_clock::now() + timeout);
+}
+
+// Both sides use sequentially consistent operations on their counters:
+// either Release sees the waiter registered, or the waiter's recheck sees
+// the permit.
+void Semaphore::Release(uint32_t count) {
+  if (count == 0u) {
+    return;
+  }
+
+  permits.fetch_add(count);
+  if (waiters.load() == 0u) {
+    return;
+  }
+  if (count == 1u) {
+    AtomicNotifyOne(permits);
+  } else {
+    AtomicNotifyAll(permits);
+  }
+}
+
+uint32_t Semaphore::GetAvailable() const { return permits.load(); }
+
+template <typename Wait>
+bool Semaphore::acquire(Wait&& wait) {
+  if (TryAcquire()) {
+    return true;
+  }
+
+  waiters.fetch_add(1u);
+  auto acquired = false;
+  while (!(acquired = TryAcquire())) {
+    if (permits.load() == 0u && !wait()) {
+      acquired = TryAcquire();
+      break;
+    }
+  }
+  waiters.fetch_sub(1u);
+  return acquired;
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
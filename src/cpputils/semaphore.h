@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "atomicwait.h"
+
+namespace CppUtils {
+namespace Synchronization {
+// Counting semaphore. Acquiring an available permit is one compare-and-swap
+// and releasing one is one atomic addition; a thread finding no permits
+// parks on the counter itself (a futex on Linux), and Release enters the
+// kernel only while somebody is parked. Permits are not fair: a thread
+// arriving while a parked one is being woken may take the permit first.
+class Semaphore {
+ public:
+  Semaphore(uint32_t permits);
+
+  void Acquire();
+  bool TryAcquire();
+
+  // Wait at most until the deadline (or for timeout); return whether a
+  // permit was acquired.
+  bool TryAcquireUntil(std::chrono::steady_clock::time_point deadline);
+  bool TryAcquireFor(std::chrono::nanoseconds timeout);
+
+  void Release(uint32_t permits = 1);
+
+  uint32_t GetAvailable() const;
+
+  Semaphore(const Semaphore&) = delete;
+  Semaphore& operator=(const Semaphore&) = delete;
+
+ private:
+  template <typename Wait>
+  bool acquire(Wait&& wait);
+
+ private:
+  std::atomic<uint32_t> permits;
+  std::atomic<uint32_t> waiters;
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
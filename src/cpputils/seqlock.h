@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "atomicwait.h"
+
+namespace CppUtils {
+namespace Synchronization {
+// Holds a small trivially copyable value that is read far more often than
+// it is written. Readers never write shared memory: they copy the value and
+// retry if the sequence number shows a writer was active meanwhile, so
+// reads scale with the number of cores. Writers exclude each other with the
+// same sequence number. The value is kept in relaxed atomic words, so the
+// torn copies a retried read may see are not data races.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type");
+
+ public:
+  SeqLock(const T& value = T()) : sequence(0u) { write(value); }
+
+  T Load() const {
+    uint64_t buffer[WORDS];
+    while (true) {
+      auto before = sequence.load(std::memory_order_acquire);
+      if (before & 1u) {
+        CpuRelax();
+        continue;
+      }
+
+      for (auto i = std::size_t(0); i < WORDS; i++) {
+        buffer[i] = words[i].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        auto value = T();
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+      }
+    }
+  }
+
+  void Store(const T& value) {
+    lock();
+    write(value);
+    unlock();
+  }
+
+  // Replaces the value with update(value) without another writer in between.
+  template <typename F>
+  void Update(F&& update) {
+    lock();
+    auto value = T();
+    read(value);
+    write(update(value));
+    unlock();
+  }
+
+  // Number of completed writes.
+  uint32_t GetVersion() const {
+    return sequence.load(std::memory_order_acquire) / 2u;
+  }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+ private:
+  static constexpr std::size_t WORDS = (sizeof(T) + 7) / 8;
+
+  void lock() {
+    auto current = sequence.load(std::memory_order_relaxed);
+    while ((current & 1u) ||
+           !sequence.compare_exchange_weak(current, current + 1u,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+      std::this_thread::yield();
+      current = sequence.load(std::memory_order_relaxed);
+    }
+    // Keeps the stores below from moving before the odd sequence number.
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void unlock() {
+    sequence.fetch_add(1u, std::memory_order_release);
+  }
+
+  // Only while holding the write lock.
+  void read(T& value) const {
+    uint64_t buffer[WORDS];
+    for (auto i = std::size_t(0); i < WORDS; i++) {
+      buffer[i] = words[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(&value, buffer, sizeof(T));
+  }
+
+  void write(const T& value) {
+    uint64_t buffer[WORDS] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (auto i = std::size_t(0); i < WORDS; i++) {
+      words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  std::atomic<uint32_t> sequence;
+  std::atomic<uint64_t> words[WORDS];
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,88 @@
+#include "serialexecutor.h"
+
+#include <algorithm>
+
+namespace CppUtils {
+namespace Execution {
+struct StrandState {
+  StrandState(Executor& executor, uint32_t batchSize)
+      : executor(executor), batchSize(batchSize), count(0ull) {}
+
+  Executor& executor;
+  const uint32_t batchSize;
+
+  MPSCQueue<Task> tasks;
+
+  // Queued plus running tasks. Whoever raises it from zero schedules the
+  // drain; the drain that brings it back to zero stops.
+  std::atomic<uint64_t> count;
+
+  // Set when the target refused the drain while tasks were queued; the next
+  // submission schedules it instead.
+  std::atomic<bool> stalled{false};
+};
+
+namespace {
+thread_local const StrandState* currentStrand = nullptr;
+
+void drain(std::shared_ptr<StrandState> state);
+
+void schedule(const std::shared_ptr<StrandState>& state) {
+  try {
+    state->executor.Execute([state]() mutable { drain(std::move(state)); });
+  } catch (const std::exception& ex) {
+    state->stalled.store(true);
+    Logger::Error("SerialExecutor could not schedule its tasks: {}",
+                  ex.what());
+  }
+}
+
+void drain(std::shared_ptr<StrandState> state) {
+  auto* previous = currentStrand;
+  currentStrand = state.get();
+
+  for (auto i = 0u; i < state->batchSize; i++) {
+    Task task;
+    while (!state->tasks.TryPop(task)) {
+      std::this_thread::yield();
+    }
+
+    try {
+      task();
+    } catch (const std::exception& ex) {
+      Logger::Error("SerialExecutor caught exception: {}", ex.what());
+    }
+    task = nullptr;
+
+    if (state->count.fetch_sub(1ull) == 1ull) {
+      currentStrand = previous;
+      return;
+    }
+  }
+
+  currentStrand = previous;
+  schedule(state);
+}
+}  // namespace
+
+SerialExecutor::SerialExecutor(Executor& executor, uint32_t batchSize)
+    : state(std::make_shared<StrandState>(executor,
+                                          std::max(batchSize, 1u))) {}
+
+void SerialExecutor::Execute(Task&& task) {
+  state->tasks.Push(std::move(task));
+
+  if (state->count.fetch_add(1ull) == 0ull ||
+      (state->stalled.load(std::memory_order_relaxed) &&
+       state->stalled.exchange(false))) {
+    schedule(state);
+  }
+}
+
+uint32_t SerialExecutor::GetConcurrency() const { return 1u; }
+
+bool SerialExecutor::IsRunningInThisThread() const {
+  return currentStrand == state.get();
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "executor.h"
+#include "logger.h"
+#include "mpscqueue.h"
+
+namespace CppUtils {
+namespace Execution {
+struct StrandState;
+
+// Strand on top of another executor: tasks run one at a time and in
+// submission order, each on whichever worker of the target picks it up, so
+// state touched only from the strand needs no lock. No thread is dedicated
+// to it; while tasks are queued one drain task on the target runs them. The
+// target must outlive every task submitted here. If the target throws when
+// handed the drain, the error is logged, the tasks stay queued and the next
+// submission tries again; nothing is lost.
+class SerialExecutor : public Executor {
+ public:
+  // A drain runs at most batchSize tasks before it yields its worker by
+  // resubmitting itself, so a busy strand cannot starve other work.
+  SerialExecutor(Executor& executor, uint32_t batchSize = 64);
+
+  void Execute(Task&& task) override;
+  uint32_t GetConcurrency() const override;
+
+  // True when called from a task of this strand.
+  bool IsRunningInThisThread() const;
+
+ private:
+  std::shared_ptr<StrandState> state;
+};
+}  // namespace Execution
+}  // namespace CppUtils
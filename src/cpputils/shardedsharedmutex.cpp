@@ -0,0 +1,130 @@
+#include "shardedsharedmutex.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "atomicwait.h"
+
+namespace CppUtils {
+namespace Synchronization {
+namespace {
+constexpr uint32_t MAX_SHARDS = 256;
+
+uint32_t shardCountOf(uint32_t requested) {
+  if (requested == 0) {
+    requested = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  auto count = 1u;
+  while (count < std::min(requested, MAX_SHARDS)) {
+    count *= 2;
+  }
+  return count;
+}
+
+// Threads get consecutive numbers on first use, so up to the shard count
+// they never share a shard.
+uint32_t threadIndex() {
+  static std::atomic<uint32_t> next(0u);
+  thread_local auto index = next.fetch_add(1u, std::memory_order_relaxed);
+  return index;
+}
+}  // namespace
+
+ShardedSharedMutex::ShardedSharedMutex(uint32_t shards)
+    : mask(shardCountOf(shards) - 1u),
+      shards(std::make_unique<Shard[]>(mask + 1u)),
+      writer(0u) {}
+
+// Writer and readers use sequentially consistent operations on the writer
+// word and the shard counts: either the writer sees a reader counted, or
+// the reader sees the writer and backs off.
+void ShardedSharedMutex::lock() {
+  while (!announce()) {
+    awaitUnlocked();
+  }
+  drain();
+}
+
+// Backs off instead of waiting for readers to leave.
+bool ShardedSharedMutex::try_lock() {
+  if (!announce()) {
+    return false;
+  }
+  for (auto i = uint32_t(0); i <= mask; i++) {
+    if (shards[i].readers.load() != 0u) {
+      unlock();
+      return false;
+    }
+  }
+  return true;
+}
+
+void ShardedSharedMutex::unlock() {
+  if (writer.exchange(0u) & WAITERS) {
+    AtomicNotifyAll(writer);
+  }
+}
+
+void ShardedSharedMutex::lock_shared() {
+  auto& current = shard();
+  while (!enter(current)) {
+    awaitUnlocked();
+  }
+}
+
+bool ShardedSharedMutex::try_lock_shared() { return enter(shard()); }
+
+void ShardedSharedMutex::unlock_shared() { leave(shard()); }
+
+ShardedSharedMutex::Shard& ShardedSharedMutex::shard() {
+  return shards[threadIndex() & mask];
+}
+
+bool ShardedSharedMutex::enter(Shard& shard) {
+  shard.readers.fetch_add(1u);
+  if (!(writer.load() & LOCKED)) {
+    return true;
+  }
+  leave(shard);
+  return false;
+}
+
+// The last reader of a shard wakes a writer that waits for it to drain.
+void ShardedSharedMutex::leave(Shard& shard) {
+  if (shard.readers.fetch_sub(1u) == 1u && (writer.load() & LOCKED)) {
+    AtomicNotifyAll(shard.readers);
+  }
+}
+
+bool ShardedSharedMutex::announce() {
+  auto current = writer.load();
+  while (!(current & LOCKED)) {
+    if (writer.compare_exchange_weak(current, current | LOCKED)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ShardedSharedMutex::awaitUnlocked() {
+  auto current = writer.load();
+  while (current & LOCKED) {
+    if (!(current & WAITERS) &&
+        !writer.compare_exchange_weak(current, current | WAITERS)) {
+      continue;
+    }
+    AtomicWait(writer, current | WAITERS);
+    current = writer.load();
+  }
+}
+
+void ShardedSharedMutex::drain() {
+  for (auto i = uint32_t(0); i <= mask; i++) {
+    auto& readers = shards[i].readers;
+    for (auto count = readers.load(); count != 0u; count = readers.load()) {
+      AtomicWait(readers, count);
+    }
+  }
+}
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace CppUtils {
+namespace Synchronization {
+// A reader-biased shared mutex for data that is read constantly and written
+// rarely. Each reader counts itself in one of several cache-line sized
+// shards, picked per thread, and only reads the shared writer word, so
+// readers on different cores do not bounce a common cache line the way
+// std::shared_mutex's reader count does. A writer announces itself, which
+// turns new readers away, then waits for every shard to drain; writing is
+// therefore more expensive than with std::shared_mutex. Meets the
+// SharedMutex requirements, so std::shared_lock and std::unique_lock work.
+class ShardedSharedMutex {
+ public:
+  // Zero picks the number of hardware threads, rounded up to a power of
+  // two.
+  ShardedSharedMutex(uint32_t shards = 0);
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  void lock_shared();
+  bool try_lock_shared();
+  void unlock_shared();
+
+  ShardedSharedMutex(const ShardedSharedMutex&) = delete;
+  ShardedSharedMutex& operator=(const ShardedSharedMutex&) = delete;
+
+ private:
+  static constexpr uint32_t LOCKED = 1;
+  static constexpr uint32_t WAITERS = 2;
+
+  struct alignas(64) Shard {
+    std::atomic<uint32_t> readers{0u};
+  };
+
+  Shard& shard();
+  bool enter(Shard& shard);
+  void leave(Shard& shard);
+  bool announce();
+  void awaitUnlocked();
+  void drain();
+
+ private:
+  const uint32_t mask;
+  std::unique_ptr<Shard[]> shards;
+
+  alignas(64) std::atomic<uint32_t> writer;
+};
+}  // namespace Synchronization
+}  // namespace CppUtils
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace CppUtils {
+namespace Execution {
+// Move-only type-erased callable. Callables up to BUFFER_SIZE bytes with a
+// non-throwing move constructor are stored inline, so wrapping a small lambda
+// never allocates; larger ones fall back to the heap.
+class Task {
+ public:
+  static constexpr std::size_t BUFFER_SIZE = 64;
+
+  Task() noexcept : operations(nullptr) {}
+  Task(std::nullptr_t) noexcept : operations(nullptr) {}
+
+  template <typename F,
+            typename Function = std::decay_t<F>,
+            typename = std::enable_if_t<!std::is_same_v<Function, Task> &&
+                                        std::is_invocable_v<Function&>>>
+  Task(F&& function) : operations(nullptr) {
+    if constexpr (isInline<Function>()) {
+      new (&buffer) Function(std::forward<F>(function));
+      operations = &inlineOperations<Function>;
+    } else {
+      auto* stored = new Function(std::forward<F>(function));
+      new (&buffer) Function*(stored);
+      operations = &heapOperations<Function>;
+    }
+  }
+
+  Task(Task&& other) noexcept : operations(other.operations) {
+    if (operations) {
+      operations->move(&other.buffer, &buffer);
+      other.operations = nullptr;
+    }
+  }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      reset();
+
+      operations = other.operations;
+      if (operations) {
+        operations->move(&other.buffer, &buffer);
+        other.operations = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  Task& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() { reset(); }
+
+  void operator()() {
+    if (!operations) {
+      throw std::bad_function_call();
+    }
+    operations->invoke(&buffer);
+  }
+
+  explicit operator bool() const noexcept { return operations != nullptr; }
+
+ private:
+  struct Operations {
+    void (*invoke)(void* buffer);
+    void (*move)(void* from, void* to) noexcept;
+    void (*destroy)(void* buffer) noexcept;
+  };
+
+  template <typename Function>
+  static constexpr bool isInline() {
+    return sizeof(Function) <= BUFFER_SIZE &&
+           alignof(Function) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<Function>;
+  }
+
+  template <typename Function>
+  static Function* inlineTarget(void* buffer) {
+    return std::launder(reinterpret_cast<Function*>(buffer));
+  }
+
+  template <typename Function>
+  static Function* heapTarget(void* buffer) {
+    return *std::launder(reinterpret_cast<Function**>(buffer));
+  }
+
+  template <typename Function>
+  static constexpr Operations inlineOperations{
+      [](void* buffer) { (*inlineTarget<Function>(buffer))(); },
+      [](void* from, void* to) noexcept {
+        auto* source = inlineTarget<Function>(from);
+        new (to) Function(std::move(*source));
+        source->~Function();
+      },
+      [](void* buffer) noexcept {
+        inlineTarget<Function>(buffer)->~Function();
+      }};
+
+  template <typename Function>
+  static constexpr Operations heapOperations{
+      [](void* buffer) { (*heapTarget<Function>(buffer))(); },
+      [](void* from, void* to) noexcept {
+        new (to) Function*(heapTarget<Function>(from));
+      },
+      [](void* buffer) noexcept { delete heapTarget<Function>(buffer); }};
+
+  void reset() noexcept {
+    if (operations) {
+      operations->destroy(&buffer);
+      operations = nullptr;
+    }
+  }
+
+ private:
+  alignas(std::max_align_t) unsigned char buffer[BUFFER_SIZE];
+  const Operations* operations;
+};
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,188 @@
+#include "taskgraph.h"
+
+namespace CppUtils {
+namespace Execution {
+TaskGraph::TaskGraph()
+    : compiled(false),
+      running(false),
+      executor(nullptr),
+      unfinished(0),
+      failed(false) {}
+
+std::size_t TaskGraph::AddNode(Task&& task) {
+  if (running) {
+    throw std::runtime_error("task graph is running");
+  }
+
+  tasks.emplace_back(std::move(task));
+  edges.emplace_back();
+  compiled = false;
+  return tasks.size() - 1;
+}
+
+void TaskGraph::AddEdge(std::size_t from, std::size_t to) {
+  if (running) {
+    throw std::runtime_error("task graph is running");
+  }
+  if (from >= tasks.size() || to >= tasks.size() || from == to) {
+    throw std::runtime_error("invalid task graph edge");
+  }
+
+  edges[from].emplace_back(to);
+  compiled = false;
+}
+
+std::size_t TaskGraph::GetNodeCount() const { return tasks.size(); }
+
+Future<void> TaskGraph::Run(Executor& executor) {
+  if (running.exchange(true)) {
+    throw std::runtime_error("task graph is running");
+  }
+
+  try {
+    compile();
+  } catch (...) {
+    running = false;
+    throw;
+  }
+
+  promise = Promise<void>(&executor);
+  auto future = promise.GetFuture();
+
+  if (tasks.empty()) {
+    running = false;
+    promise.SetValue();
+    return future;
+  }
+
+  this->executor = &executor;
+  for (auto i = std::size_t(0); i < tasks.size(); i++) {
+    remaining[i].store(predecessors[i], std::memory_order_relaxed);
+  }
+  unfinished.store(tasks.size(), std::memory_order_relaxed);
+  failed.store(false, std::memory_order_relaxed);
+  error = nullptr;
+
+  // Once the last root is handed over, the graph may finish and be gone.
+  auto nRoots = roots.size();
+  for (auto i = std::size_t(0); i < nRoots; i++) {
+    dispatch(roots[i]);
+  }
+  return future;
+}
+
+void TaskGraph::compile() {
+  if (compiled) {
+    return;
+  }
+
+  auto size = tasks.size();
+  offsets.assign(size + 1, 0);
+  successors.clear();
+  predecessors.assign(size, 0u);
+  roots.clear();
+
+  for (auto i = std::size_t(0); i < size; i++) {
+    offsets[i] = successors.size();
+    for (auto to : edges[i]) {
+      successors.emplace_back(to);
+      predecessors[to]++;
+    }
+  }
+  offsets[size] = successors.size();
+
+  for (auto i = std::size_t(0); i < size; i++) {
+    if (predecessors[i] == 0u) {
+      roots.emplace_back(i);
+    }
+  }
+
+  // Kahn's algorithm: every node is reachable from the roots only if there
+  // is no cycle.
+  auto order = roots;
+  auto counts = predecessors;
+  for (auto i = std::size_t(0); i < order.size(); i++) {
+    for (auto j = offsets[order[i]]; j < offsets[order[i] + 1]; j++) {
+      if (--counts[successors[j]] == 0u) {
+        order.emplace_back(successors[j]);
+      }
+    }
+  }
+  if (order.size() != size) {
+    throw std::runtime_error("task graph has a cycle");
+  }
+
+  remaining = std::make_unique<std::atomic<uint32_t>[]>(size);
+  compiled = true;
+}
+
+// If the executor refuses the node, the run fails and the node is skipped
+// on this thread, so it and its successors are still accounted for.
+void TaskGraph::dispatch(std::size_t index) {
+  try {
+    executor->Execute([this, index] { runNode(index); });
+  } catch (...) {
+    fail(std::current_exception());
+    runNode(index);
+  }
+}
+
+void TaskGraph::runNode(std::size_t index) {
+  // Once unfinished is decremented, another thread may finish the run and
+  // the graph may be destroyed, so only locals are used after that.
+  const auto none = tasks.size();
+
+  while (true) {
+    if (!failed.load(std::memory_order_acquire)) {
+      try {
+        tasks[index]();
+      } catch (...) {
+        fail(std::current_exception());
+      }
+    }
+
+    // Keep the last ready successor on this thread.
+    auto next = none;
+    for (auto i = offsets[index]; i < offsets[index + 1]; i++) {
+      auto successor = successors[i];
+      if (remaining[successor].fetch_sub(1u, std::memory_order_acq_rel) ==
+          1u) {
+        if (next != none) {
+          dispatch(next);
+        }
+        next = successor;
+      }
+    }
+
+    if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      finish();
+      return;
+    }
+    if (next == none) {
+      return;
+    }
+    index = next;
+  }
+}
+
+void TaskGraph::fail(std::exception_ptr exception) {
+  auto lock = Synchronization::InternalLock(mx);
+  if (!error) {
+    error = std::move(exception);
+  }
+  failed.store(true, std::memory_order_release);
+}
+
+void TaskGraph::finish() {
+  auto done = std::move(promise);
+  auto exception = error;
+
+  running = false;
+  if (exception) {
+    done.SetException(exception);
+  } else {
+    done.SetValue();
+  }
+}
+}  // namespace Execution
+}  // namespace CppUtils
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "executor.h"
+#include "profiledmutex.h"
+
+namespace CppUtils {
+namespace Execution {
+// Directed acyclic graph of tasks. Run() dispatches every node as soon as all
+// of its predecessors have finished; a node with several ready successors
+// keeps one of them on its own thread and submits the rest. The graph is
+// compiled once after it changes, so later runs only reset counters and
+// allocate nothing but the returned future's state.
+class TaskGraph {
+ public:
+  TaskGraph();
+
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  // Nodes are numbered in the order they are added. Their tasks are invoked
+  // once per run, so they must be callable repeatedly.
+  std::size_t AddNode(Task&& task);
+
+  // to starts only after from has finished.
+  void AddEdge(std::size_t from, std::size_t to);
+
+  std::size_t GetNodeCount() const;
+
+  // The returned future is ready when every node has finished. After a node
+  // throws or the executor refuses one, nodes that have not started are
+  // skipped and the first exception is set on the future. The graph must outlive the run and must not be
+  // changed or run again before the future is ready.
+  Future<void> Run(Executor& executor);
+
+ private:
+  void compile();
+  void dispatch(std::size_t index);
+  void runNode(std::size_t index);
+  void fail(std::exception_ptr exception);
+  void finish();
+
+ private:
+  std::vector<Task> tasks;
+  std::vector<std::vector<std::size_t>> edges;
+
+  // Compiled adjacency: successors of node i are
+  // successors[offsets[i]] .. successors[offsets[i + 1]].
+  bool compiled;
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> successors;
+  std::vector<uint32_t> predecessors;
+  std::vector<std::size_t> roots;
+
+  // Per-run state.
+  std::atomic<bool> running;
+  Executor* executor;
+  std::unique_ptr<std::atomic<uint32_t>[]> remaining;
+  std::atomic<std::size_t> unfinished;
+  std::atomic<bool> failed;
+  std::exception_ptr error;
+  Synchronization::InternalMutex mx{"TaskGraph::mx"};
+  Promise<void> promise;
+};
+}  // namespace Execution
+}  // namespace CppUtils
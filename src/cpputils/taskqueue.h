@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+
+#include "executor.h"
+
+namespace CppUtils {
+namespace Execution {
+// A task waiting for a worker. enqueued is the submission time in
+// ExecutorMetrics::Now() ticks, or zero when nobody measures it.
+struct QueuedTask {
+  Task task;
+  uint64_t enqueued = 0;
+};
+
+class TaskQueue {
+ public:
+  virtual ~TaskQueue() = default;
+
+  // Takes the task only when it returns true.
+  virtual bool TryPush(QueuedTask&& task) = 0;
+  virtual bool TryPop(QueuedTask& task) = 0;
+
+  // Pushes tasks from the front of the range, all stamped with the same
+  // submission time, and returns how many were taken.
+  virtual std::size_t TryPushBatch(Task* batch, std::size_t count,
+                                   uint64_t enqueued) {
+    auto pushed = std::size_t(0);
+    while (pushed < count) {
+      auto task = QueuedTask{std::move(batch[pushed]), enqueued};
+      if (!TryPush(std::move(task))) {
+        // A full queue leaves the task with the caller.
+        batch[pushed] = std::move(task.task);
+        break;
+      }
+      pushed++;
+    }
+    return pushed;
+  }
+};
+}  // namespace Execution
+}  // namespace CppUtils
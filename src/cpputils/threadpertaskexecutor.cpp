@@ -2,37 +2,75 @@
 
 namespace CppUtils {
 namespace Execution {
-ThreadPerTaskExecutor::ThreadPerTaskExecutor() {}
+ThreadPerTaskExecutor::ThreadPerTaskExecutor(bool collectStats) {
+  if (collectStats) {
+    metrics = std::make_unique<ExecutorMetrics>(1, false);
+  }
+}
 
 ThreadPerTaskExecutor::~ThreadPerTaskExecutor() {
-  auto lock = std::unique_lock<std::mutex>(mx);
+  auto lock = Synchronization::InternalLock(mx);
   auto predicate = [this] { return workers.empty(); };
 
   cv.wait(lock, predicate);
 }
 
-void ThreadPerTaskExecutor::Execute(const Task& task) {
-  std::thread([this, task] {
+void ThreadPerTaskExecutor::Execute(Task&& task) {
+  auto enqueued = metrics ? ExecutorMetrics::Now() : 0;
+
+  std::thread([this, enqueued, task = std::move(task)]() mutable {
     auto threadID = std::this_thread::get_id();
 
     {
-      auto lock = std::unique_lock<std::mutex>(mx);
+      auto lock = Synchronization::InternalLock(mx);
       workers.emplace(threadID);
     }
 
+    auto started = uint64_t(0);
+    if (metrics) {
+      started = ExecutorMetrics::Now();
+      metrics->RecordStart(0, ExecutorMetrics::Elapsed(enqueued, started));
+    }
+
+    auto failed = false;
     try {
       task();
     } catch (const std::exception& ex) {
+      failed = true;
       Logger::Warning("ThreadPerTaskExecutor caught exception: {}", ex.what());
     }
 
+    if (metrics) {
+      metrics->RecordFinish(
+          0, ExecutorMetrics::Elapsed(started, ExecutorMetrics::Now()), failed);
+    }
+
     {
-      auto lock = std::unique_lock<std::mutex>(mx);
+      auto lock = Synchronization::InternalLock(mx);
       workers.erase(threadID);
 
       cv.notify_all();
     }
   }).detach();
 }
+
+ExecutorStats ThreadPerTaskExecutor::GetStats() const {
+  auto lock = Synchronization::InternalLock(mx);
+  auto threads = static_cast<uint32_t>(workers.size());
+  lock.unlock();
+
+  if (!metrics) {
+    auto stats = ExecutorStats();
+    stats.threads = threads;
+    return stats;
+  }
+  return metrics->Snapshot(0, threads);
+}
+
+void ThreadPerTaskExecutor::ResetStats() {
+  if (metrics) {
+    metrics->Reset();
+  }
+}
 }  // namespace Execution
 }  // namespace CppUtils
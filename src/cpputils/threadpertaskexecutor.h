@@ -1,26 +1,35 @@
 #pragma once
 #include <algorithm>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <thread>
 
 #include "executor.h"
+#include "executorstats.h"
 #include "logger.h"
+#include "profiledmutex.h"
 
 namespace CppUtils {
 namespace Execution {
 class ThreadPerTaskExecutor : public Executor {
  public:
-  ThreadPerTaskExecutor();
+  // With collectStats the wait time of a task is its thread's start-up time.
+  ThreadPerTaskExecutor(bool collectStats = false);
   ~ThreadPerTaskExecutor();
 
-  void Execute(const Task& task);
+  void Execute(Task&& task) override;
+
+  // Without collectStats only threads is filled in.
+  ExecutorStats GetStats() const;
+  void ResetStats();
 
  private:
   std::set<std::thread::id> workers;
+  std::unique_ptr<ExecutorMetrics> metrics;
 
-  std::mutex mx;
-  std::condition_variable cv;
+  mutable Synchronization::InternalMutex mx{"ThreadPerTaskExecutor::mx"};
+  Synchronization::InternalConditionVariable cv;
 };
 }  // namespace Execution
 }  // namespace CppUtils
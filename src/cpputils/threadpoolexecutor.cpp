@@ -1,60 +1,662 @@
 #include "threadpoolexecutor.h"
 
+#include <map>
+#include <tuple>
+
 namespace CppUtils {
 namespace Execution {
-ThreadPoolExecutor::ThreadPoolExecutor(uint32_t nThreads) : running(true) {
-  for (auto i = 0u; i < nThreads; i++) {
-    workers.emplace_back(std::thread(&ThreadPoolExecutor::threadFunc, this));
+namespace {
+thread_local const void* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+std::vector<uint32_t> orderCompact(const CpuTopology& topology) {
+  auto cpus = topology.GetCpus();
+  std::sort(cpus.begin(), cpus.end(), [](const CpuInfo& a, const CpuInfo& b) {
+    return std::tie(a.node, a.package, a.core, a.id) <
+           std::tie(b.node, b.package, b.core, b.id);
+  });
+
+  std::vector<uint32_t> order;
+  for (auto& cpu : cpus) {
+    order.emplace_back(cpu.id);
+  }
+  return order;
+}
+
+// Round-robin over nodes; within a node, one hardware thread of every
+// physical core before any of their siblings.
+std::vector<uint32_t> orderScatter(const CpuTopology& topology) {
+  std::vector<std::vector<CpuInfo>> nodes(topology.GetNodes().size());
+  std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint32_t> siblings;
+  std::map<uint32_t, uint32_t> ranks;
+
+  for (auto& cpu : topology.GetCpus()) {
+    auto core = std::make_tuple(cpu.node, cpu.package, cpu.core);
+    ranks[cpu.id] = siblings[core]++;
+    nodes[cpu.node].emplace_back(cpu);
+  }
+  for (auto& node : nodes) {
+    std::sort(node.begin(), node.end(),
+              [&ranks](const CpuInfo& a, const CpuInfo& b) {
+                return std::make_tuple(ranks[a.id], a.package, a.core, a.id) <
+                       std::make_tuple(ranks[b.id], b.package, b.core, b.id);
+              });
+  }
+
+  std::vector<uint32_t> order;
+  auto size = topology.GetCpus().size();
+  for (auto i = std::size_t(0); order.size() < size; i++) {
+    for (auto& node : nodes) {
+      if (i < node.size()) {
+        order.emplace_back(node[i].id);
+      }
+    }
+  }
+  return order;
+}
+
+uint32_t maxThreadsOf(const ThreadPoolOptions& options) {
+  if (options.maxThreads == 0) {
+    return std::max(options.threads, std::thread::hardware_concurrency());
+  }
+  if (options.threads > options.maxThreads) {
+    throw std::runtime_error("invalid thread count");
+  }
+  return options.maxThreads;
+}
+
+std::vector<std::vector<uint32_t>> placeWorkers(
+    const ThreadPoolOptions& options) {
+  auto& topology = CpuTopology::Get();
+  auto placement = std::vector<std::vector<uint32_t>>(maxThreadsOf(options));
+
+  std::vector<uint32_t> order;
+  switch (options.placement) {
+    case WorkerPlacement::None:
+      return placement;
+    case WorkerPlacement::Compact:
+      order = orderCompact(topology);
+      break;
+    case WorkerPlacement::Scatter:
+      order = orderScatter(topology);
+      break;
+    case WorkerPlacement::Explicit:
+      if (options.cpus.empty()) {
+        throw std::runtime_error("no cpus given for explicit placement");
+      }
+      order = options.cpus;
+      break;
+    case WorkerPlacement::NumaNodes: {
+      auto& nodes = topology.GetNodes();
+      for (auto i = std::size_t(0); i < placement.size(); i++) {
+        placement[i] = nodes[i % nodes.size()];
+      }
+      return placement;
+    }
+  }
+
+  for (auto i = std::size_t(0); i < placement.size(); i++) {
+    placement[i] = {order[i % order.size()]};
+  }
+  return placement;
+}
+}  // namespace
+
+ThreadPoolExecutor::ThreadPoolExecutor(uint32_t nThreads)
+    : ThreadPoolExecutor([nThreads] {
+        auto options = ThreadPoolOptions();
+        options.threads = nThreads;
+        return options;
+      }()) {}
+
+ThreadPoolExecutor::ThreadPoolExecutor(const ThreadPoolOptions& options)
+    : running(true),
+      workStealing(options.workStealing),
+      maxThreads(maxThreadsOf(options)),
+      target(0u),
+      workers(maxThreads),
+      alive(maxThreads, false),
+      workerCpus(placeWorkers(options)),
+      pending(0ull),
+      maxQueued(options.maxQueued),
+      rejection(options.rejection),
+      blocked(0ull),
+      callerRuns(0ull),
+      rejected(0ull),
+      discarded(0ull),
+      spinTime(std::max(options.spinTime, std::chrono::microseconds(0))),
+      spinning(0u) {
+  if (options.collectStats) {
+    metrics = std::make_unique<ExecutorMetrics>(maxThreads, true);
+  }
+
+  auto nQueues = std::size_t(1);
+  if (options.placement == WorkerPlacement::NumaNodes) {
+    nQueues = CpuTopology::Get().GetNodes().size();
+  }
+
+  for (auto i = std::size_t(0); i < nQueues; i++) {
+    if (options.queue == TaskQueueType::LockFree) {
+      tasks.emplace_back(
+          std::make_unique<LockFreeTaskQueue>(options.queueCapacity));
+    } else {
+      tasks.emplace_back(std::make_unique<LockedTaskQueue>());
+    }
+  }
+
+  for (auto i = 0u; i < maxThreads; i++) {
+    workerNodes.emplace_back(i % nQueues);
+
+    if (workStealing) {
+      localQueues.emplace_back(std::make_unique<WorkQueue>());
+    }
+  }
+
+  auto lock = Synchronization::InternalLock(resizeMx);
+  resize(options.threads, lock);
+  lock.unlock();
+
+  if (options.autoscale) {
+    monitor = std::thread(&ThreadPoolExecutor::monitorFunc, this, options);
   }
 }
 
 ThreadPoolExecutor::~ThreadPoolExecutor() {
   {
-    auto lock = std::unique_lock<std::mutex>(mx);
+    auto lock = Synchronization::InternalLock(resizeMx);
     running = false;
 
-    cv.notify_all();
+    resizeCv.notify_all();
   }
+  idle.NotifyAll();
 
+  if (monitor.joinable()) {
+    monitor.join();
+  }
   for (auto& worker : workers) {
-    worker.join();
+    if (worker.joinable()) {
+      worker.join();
+    }
   }
 }
 
-void ThreadPoolExecutor::Execute(const Task& task) {
-  auto lock = std::unique_lock<std::mutex>(mx);
+void ThreadPoolExecutor::Execute(Task&& task) {
+  auto enqueued = metrics ? ExecutorMetrics::Now() : 0;
+  auto entry = QueuedTask{std::move(task), enqueued};
+
+  if (!admit(entry)) {
+    return;
+  }
+
+  if (workStealing && currentPool == this) {
+    pushLocal(currentWorker, std::move(entry));
+  } else {
+    auto& queue = submissionQueue();
+    while (!queue.TryPush(std::move(entry))) {
+      if (currentPool == this) {
+        runInline(entry.task);
+        return;
+      }
+      std::this_thread::yield();
+    }
+  }
 
-  tasks.emplace(task);
-  cv.notify_all();
+  notify();
 }
 
-void ThreadPoolExecutor::threadFunc() {
-  while (true) {
-    Task task;
-    {
-      auto lock = std::unique_lock<std::mutex>(mx);
-      auto predicate = [this] { return !tasks.empty() || !running; };
+void ThreadPoolExecutor::ExecuteBatch(std::vector<Task>&& batch) {
+  // Whatever does not fit into a bounded queue goes through the rejection
+  // policy one task at a time.
+  auto admitted = batch.size();
+  if (maxQueued == 0) {
+    pending.fetch_add(admitted);
+  } else {
+    admitted = reserve(admitted);
+  }
+
+  if (admitted > 0) {
+    auto enqueued = metrics ? ExecutorMetrics::Now() : 0;
+
+    if (workStealing && currentPool == this) {
+      auto& queue = *localQueues[currentWorker];
+      auto lock = Synchronization::InternalLock(queue.mx);
+
+      for (auto i = std::size_t(0); i < admitted; i++) {
+        queue.tasks.PushBack(QueuedTask{std::move(batch[i]), enqueued});
+      }
+      lock.unlock();
+
+      notify(admitted);
+    } else {
+      auto& queue = submissionQueue();
 
-      cv.wait(lock, predicate);
+      auto pushed = std::size_t(0);
+      while (true) {
+        pushed += queue.TryPushBatch(batch.data() + pushed, admitted - pushed,
+                                     enqueued);
+        if (pushed == admitted || currentPool == this) {
+          break;
+        }
+        std::this_thread::yield();
+      }
 
-      if (!running) {
-        break;
+      notify(pushed);
+      for (auto i = pushed; i < admitted; i++) {
+        runInline(batch[i]);
       }
+    }
+  }
+
+  for (auto i = admitted; i < batch.size(); i++) {
+    Execute(std::move(batch[i]));
+  }
+}
+
+ExecutorStats ThreadPoolExecutor::GetStats() const {
+  auto threads = GetThreadCount();
+  auto stats = ExecutorStats();
+  if (metrics) {
+    stats = metrics->Snapshot(pending.load(), threads);
+  } else {
+    stats.queued = pending.load();
+    stats.threads = threads;
+  }
+
+  stats.blocked = blocked.load();
+  stats.callerRuns = callerRuns.load();
+  stats.rejected = rejected.load();
+  stats.discarded = discarded.load();
+  return stats;
+}
+
+void ThreadPoolExecutor::ResetStats() {
+  if (metrics) {
+    metrics->Reset();
+  }
+
+  blocked = 0ull;
+  callerRuns = 0ull;
+  rejected = 0ull;
+  discarded = 0ull;
+}
+
+void ThreadPoolExecutor::Resize(uint32_t nThreads) {
+  if (nThreads == 0 || nThreads > maxThreads) {
+    throw std::runtime_error("invalid thread count");
+  }
 
-      if (tasks.empty()) {
+  auto lock = Synchronization::InternalLock(resizeMx);
+  resize(nThreads, lock);
+}
+
+uint32_t ThreadPoolExecutor::GetThreadCount() const { return target.load(); }
+
+uint32_t ThreadPoolExecutor::GetConcurrency() const {
+  return std::max(GetThreadCount(), 1u);
+}
+
+uint32_t ThreadPoolExecutor::GetMaxThreadCount() const { return maxThreads; }
+
+void ThreadPoolExecutor::resize(uint32_t nThreads,
+                                Synchronization::InternalLock& lock) {
+  auto previous = target.exchange(nThreads);
+
+  // A worker above the new target that has not noticed yet keeps its slot.
+  for (auto i = 0u; i < nThreads; i++) {
+    if (alive[i]) {
+      continue;
+    }
+    if (workers[i].joinable()) {
+      workers[i].join();
+    }
+    alive[i] = true;
+    workers[i] = std::thread(&ThreadPoolExecutor::threadFunc, this, i);
+  }
+
+  if (nThreads < previous) {
+    lock.unlock();
+    idle.NotifyAll();
+    lock.lock();
+  }
+}
+
+void ThreadPoolExecutor::monitorFunc(const ThreadPoolOptions& options) {
+  auto minThreads = std::clamp(options.minThreads, 1u, maxThreads);
+  auto interval =
+      std::max(options.scaleInterval, std::chrono::milliseconds(1));
+  auto idleRounds = static_cast<uint64_t>(options.idleTimeout / interval);
+
+  auto lastQueued = uint64_t(0);
+  auto idleFor = uint64_t(0);
+
+  auto lock = Synchronization::InternalLock(resizeMx);
+  while (running) {
+    resizeCv.wait_for(lock, interval);
+    if (!running) {
+      break;
+    }
+
+    auto queued = pending.load();
+    auto current = target.load();
+
+    if (queued > 0 && queued >= lastQueued) {
+      idleFor = 0;
+      if (current < maxThreads) {
+        resize(current + 1, lock);
+      }
+    } else if (queued == 0 && idle.GetWaiterCount() > 0) {
+      if (++idleFor >= idleRounds && current > minThreads) {
+        idleFor = 0;
+        resize(current - 1, lock);
+      }
+    } else {
+      idleFor = 0;
+    }
+    lastQueued = queued;
+  }
+}
+
+void ThreadPoolExecutor::threadFunc(std::size_t index) {
+  currentPool = this;
+  currentWorker = index;
+
+  if (!workerCpus[index].empty() && !CpuTopology::Pin(workerCpus[index])) {
+    Logger::Warning("ThreadPoolExecutor failed to pin worker {}", index);
+  }
+
+  // A busy worker takes the previous task's finish time as the next one's
+  // start, so measuring costs one clock read per task on each side.
+  auto finished = uint64_t(0);
+
+  while (running) {
+    if (index >= target.load(std::memory_order_relaxed) && retire(index)) {
+      break;
+    }
+
+    QueuedTask entry;
+    if (!popTask(index, entry)) {
+      finished = 0;
+
+      if (!waitForTask(index, entry)) {
         continue;
       }
+    }
+
+    auto started = uint64_t(0);
+    if (metrics) {
+      started = finished != 0 && finished >= entry.enqueued
+                    ? finished
+                    : ExecutorMetrics::Now();
+      metrics->RecordStart(index,
+                           ExecutorMetrics::Elapsed(entry.enqueued, started));
+    }
+
+    auto failed = !runTask(entry.task);
+
+    if (metrics) {
+      finished = ExecutorMetrics::Now();
+      metrics->RecordFinish(index, ExecutorMetrics::Elapsed(started, finished),
+                            failed);
+    }
+  }
+
+  currentPool = nullptr;
+}
+
+bool ThreadPoolExecutor::popTask(std::size_t index, QueuedTask& task) {
+  if (workStealing && popLocal(index, task)) {
+    return true;
+  }
+
+  auto node = workerNodes[index];
+  for (auto i = std::size_t(0); i < tasks.size(); i++) {
+    if (tasks[(node + i) % tasks.size()]->TryPop(task)) {
+      dequeued();
+      return true;
+    }
+  }
+
+  return workStealing && steal(index, task);
+}
+
+// Polls for spinTime, then parks until a task may have arrived. Returns false
+// when the worker wakes up without a task.
+bool ThreadPoolExecutor::waitForTask(std::size_t index, QueuedTask& task) {
+  if (spinTime.count() > 0) {
+    spinning.fetch_add(1u);
+    auto found = spin(index, task);
+    spinning.fetch_sub(1u);
+
+    if (found) {
+      // Submitters skip the wakeup while a worker spins, so pass it on if
+      // this worker was not the only one needed.
+      if (pending.load() > 0ull) {
+        notify();
+      }
+      return true;
+    }
+  }
+
+  auto key = idle.PrepareWait();
+  if (pending.load() > 0ull || !running || index >= target.load()) {
+    idle.CancelWait();
+    return false;
+  }
+
+  idle.Wait(key);
+  return false;
+}
+
+bool ThreadPoolExecutor::spin(std::size_t index, QueuedTask& task) {
+  static constexpr uint32_t BUSY_ROUNDS = 64;
+  auto deadline = std::chrono::steady_clock::now() + spinTime;
+
+  for (auto round = 0u; running && index < target.load(); round++) {
+    if (pending.load(std::memory_order_relaxed) > 0ull &&
+        popTask(index, task)) {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+
+    if (round < BUSY_ROUNDS) {
+      Synchronization::CpuRelax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  return false;
+}
 
-      task = tasks.front();
-      tasks.pop();
+// Takes a place in the queue for the task, following the rejection policy
+// when the queue is full. Returns false if the task was dealt with instead.
+bool ThreadPoolExecutor::admit(QueuedTask& task) {
+  if (maxQueued == 0) {
+    pending.fetch_add(1ull);
+    return true;
+  }
+
+  auto waited = false;
+  while (reserve(1) == 0) {
+    switch (rejection) {
+      case RejectionPolicy::Block:
+        if (currentPool != this) {
+          auto key = space.PrepareWait();
+          if (pending.load() < maxQueued) {
+            space.CancelWait();
+            continue;
+          }
+
+          if (!waited) {
+            waited = true;
+            blocked.fetch_add(1ull);
+          }
+          space.Wait(key);
+          continue;
+        }
+        [[fallthrough]];
+      case RejectionPolicy::CallerRuns:
+        callerRuns.fetch_add(1ull);
+        runTask(task.task);
+        return false;
+      case RejectionPolicy::Reject:
+        rejected.fetch_add(1ull);
+        throw std::runtime_error("executor queue is full");
+      case RejectionPolicy::DiscardOldest:
+        // The evicted task's place goes to the new one.
+        if (evictOldest()) {
+          discarded.fetch_add(1ull);
+          return true;
+        }
+        std::this_thread::yield();
+        continue;
     }
+  }
+  return true;
+}
 
-    try {
-      task();
-    } catch (const std::exception& ex) {
-      Logger::Error("ThreadPoolExecutor caught exception: {}", ex.what());
+std::size_t ThreadPoolExecutor::reserve(std::size_t count) {
+  auto current = pending.load();
+  while (current < maxQueued) {
+    auto granted = std::min<uint64_t>(count, maxQueued - current);
+    if (pending.compare_exchange_weak(current, current + granted)) {
+      return static_cast<std::size_t>(granted);
     }
   }
+  return 0;
+}
+
+// With workStealing, tasks that workers submit sit in their deques, which
+// may hold everything queued; those lose their oldest end.
+bool ThreadPoolExecutor::evictOldest() {
+  QueuedTask victim;
+  for (auto& queue : tasks) {
+    if (queue->TryPop(victim)) {
+      return true;
+    }
+  }
+
+  if (workStealing) {
+    for (auto& queue : localQueues) {
+      auto lock = Synchronization::InternalLock(queue->mx);
+      if (!queue->tasks.Empty()) {
+        victim = queue->tasks.PopFront();
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void ThreadPoolExecutor::dequeued() {
+  pending.fetch_sub(1ull);
+  if (maxQueued != 0 && rejection == RejectionPolicy::Block) {
+    space.NotifyOne();
+  }
+}
+
+// A worker that finds the bounded ring full runs an admitted task itself: if
+// every worker waited for room, nobody would be left to pop.
+void ThreadPoolExecutor::runInline(Task& task) {
+  dequeued();
+  callerRuns.fetch_add(1ull);
+  runTask(task);
+}
+
+bool ThreadPoolExecutor::runTask(Task& task) {
+  try {
+    task();
+    return true;
+  } catch (const std::exception& ex) {
+    Logger::Error("ThreadPoolExecutor caught exception: {}", ex.what());
+    return false;
+  }
+}
+
+// A surplus worker first empties its own deque, since nobody else pushes
+// there and only stealing would drain it.
+bool ThreadPoolExecutor::retire(std::size_t index) {
+  if (workStealing) {
+    auto& queue = *localQueues[index];
+    auto lock = Synchronization::InternalLock(queue.mx);
+    if (!queue.tasks.Empty()) {
+      return false;
+    }
+  }
+
+  auto lock = Synchronization::InternalLock(resizeMx);
+  if (index < target.load()) {
+    return false;
+  }
+
+  alive[index] = false;
+  return true;
+}
+
+TaskQueue& ThreadPoolExecutor::submissionQueue() {
+  if (tasks.size() == 1) {
+    return *tasks.front();
+  }
+  if (currentPool == this) {
+    return *tasks[workerNodes[currentWorker]];
+  }
+  return *tasks[CpuTopology::Get().GetCurrentNode() % tasks.size()];
+}
+
+// Called after pending has been raised. A spinning worker either finds the
+// task or sees pending when it rechecks before parking, so only the tasks
+// beyond the number of spinners need a parked worker.
+void ThreadPoolExecutor::notify(std::size_t count) {
+  auto nSpinning = std::size_t(spinning.load());
+  if (count <= nSpinning) {
+    return;
+  }
+  count -= nSpinning;
+
+  if (count >= idle.GetWaiterCount()) {
+    idle.NotifyAll();
+    return;
+  }
+  for (auto i = std::size_t(0); i < count; i++) {
+    idle.NotifyOne();
+  }
+}
+
+void ThreadPoolExecutor::pushLocal(std::size_t index, QueuedTask&& task) {
+  auto& queue = *localQueues[index];
+  auto lock = Synchronization::InternalLock(queue.mx);
+
+  queue.tasks.PushBack(std::move(task));
+}
+
+bool ThreadPoolExecutor::popLocal(std::size_t index, QueuedTask& task) {
+  auto& queue = *localQueues[index];
+  auto lock = Synchronization::InternalLock(queue.mx);
+
+  if (queue.tasks.Empty()) {
+    return false;
+  }
+
+  task = queue.tasks.PopBack();
+  dequeued();
+  return true;
+}
+
+bool ThreadPoolExecutor::steal(std::size_t index, QueuedTask& task) {
+  for (auto i = std::size_t(1); i < localQueues.size(); i++) {
+    auto& victim = *localQueues[(index + i) % localQueues.size()];
+    auto lock = Synchronization::InternalLock(victim.mx, std::try_to_lock);
+
+    if (!lock.owns_lock() || victim.tasks.Empty()) {
+      continue;
+    }
+
+    task = victim.tasks.PopFront();
+    dequeued();
+    return true;
+  }
+  return false;
 }
 }  // namespace Execution
 }  // namespace CppUtils
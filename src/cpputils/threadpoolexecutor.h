@@ -1,33 +1,212 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <stdexcept>
 #include <thread>
 #include <vector>
 
+#include "cputopology.h"
+#include "eventcount.h"
 #include "executor.h"
+#include "executorstats.h"
+#include "lockedtaskqueue.h"
+#include "lockfreetaskqueue.h"
 #include "logger.h"
+#include "parallelloop.h"
+#include "profiledmutex.h"
+#include "ringbuffer.h"
 
 namespace CppUtils {
 namespace Execution {
+enum class TaskQueueType { Locked, LockFree };
+
+// Compact packs workers onto neighbouring CPUs (sharing cores and caches),
+// Scatter spreads them over nodes and physical cores first, Explicit pins
+// worker i to cpus[i % cpus.size()]. NumaNodes splits the pool into one
+// sub-pool per NUMA node: its workers may run on any CPU of the node and
+// take tasks from the node's own queue before those of other nodes, and
+// submissions go to the queue of the submitting thread's node.
+enum class WorkerPlacement { None, Compact, Scatter, Explicit, NumaNodes };
+
+// What a submission does when maxQueued tasks are already waiting. Block
+// waits for a free slot; a worker of the pool runs the task itself instead,
+// since it might be the one that has to free the slot. CallerRuns runs the
+// task on the submitting thread, Reject throws std::runtime_error and
+// DiscardOldest drops the longest-waiting task of the shared queue to make
+// room, or the oldest task of a worker's deque when the shared queue is empty.
+enum class RejectionPolicy { Block, CallerRuns, Reject, DiscardOldest };
+
+struct ThreadPoolOptions {
+  uint32_t threads = std::thread::hardware_concurrency();
+
+  // Each worker owns a deque: tasks submitted from a worker stay on it, and
+  // idle workers steal from the others instead of sharing one locked queue.
+  bool workStealing = false;
+
+  // LockFree replaces the mutex-protected queue with a bounded ring of
+  // queueCapacity slots, so submitting never waits for a worker's lock.
+  // When the ring is full, other threads wait for room while a worker of
+  // the pool runs the task itself (counted as callerRuns).
+  TaskQueueType queue = TaskQueueType::Locked;
+  std::size_t queueCapacity = 4096;
+
+  WorkerPlacement placement = WorkerPlacement::None;
+  std::vector<uint32_t> cpus;
+
+  // Zero leaves the pool unbounded.
+  std::size_t maxQueued = 0;
+  RejectionPolicy rejection = RejectionPolicy::Block;
+
+  // Counts tasks and records wait and run time histograms for GetStats().
+  bool collectStats = false;
+
+  // An idle worker keeps polling for spinTime before it parks, busy-waiting
+  // at first and then yielding its CPU, so a burst of tasks finds it awake.
+  // Zero parks right away. Each submission wakes at most one parked worker,
+  // and none while another worker is still polling.
+  std::chrono::microseconds spinTime = std::chrono::microseconds(50);
+
+  // Upper bound for Resize() and the autoscaler; zero means the larger of
+  // threads and hardware_concurrency().
+  uint32_t maxThreads = 0;
+
+  // Every scaleInterval the autoscaler adds a worker if tasks are queued and
+  // the queue has not shrunk since the last check, and removes one once
+  // workers have sat parked with nothing queued for idleTimeout, but never
+  // goes below minThreads.
+  bool autoscale = false;
+  uint32_t minThreads = 1;
+  std::chrono::milliseconds scaleInterval = std::chrono::milliseconds(100);
+  std::chrono::milliseconds idleTimeout = std::chrono::seconds(10);
+};
+
 class ThreadPoolExecutor : public Executor {
  public:
   ThreadPoolExecutor(uint32_t nThreads = std::thread::hardware_concurrency());
+  ThreadPoolExecutor(const ThreadPoolOptions& options);
   ~ThreadPoolExecutor();
 
-  void Execute(const Task& task) override;
+  void Execute(Task&& task) override;
+  uint32_t GetConcurrency() const override;
+
+  // Enqueues all tasks with one queue operation and wakes at most as many
+  // workers as there are tasks.
+  void ExecuteBatch(std::vector<Task>&& batch);
+
+  // Without collectStats only queued, threads and the rejection counters are
+  // filled in.
+  ExecutorStats GetStats() const;
+  void ResetStats();
+
+  // Starts workers or lets the surplus ones exit once they have finished
+  // their current task (and, with work stealing, their own deque). Returns
+  // without waiting for them.
+  void Resize(uint32_t nThreads);
+  uint32_t GetThreadCount() const;
+  uint32_t GetMaxThreadCount() const;
+
+  // Calls function(i) for every i in [begin, end) on the pool and the calling
+  // thread, and returns once all iterations are done. Chunks never get
+  // smaller than grain; the first exception thrown is rethrown here.
+  template <typename Index, typename F>
+  void ParallelFor(Index begin, Index end, Index grain, F&& function) {
+    if (end <= begin) {
+      return;
+    }
+
+    auto size = static_cast<std::size_t>(end - begin);
+    auto chunk = std::max(static_cast<std::size_t>(grain), std::size_t(1));
+    auto helpers = std::min<std::size_t>(GetThreadCount(), size / chunk);
+    auto loop = std::make_shared<ParallelLoop>(size, chunk, helpers + 1);
+    auto body = [begin, &function](std::size_t from, std::size_t to) {
+      for (auto i = from; i < to; i++) {
+        function(static_cast<Index>(begin + i));
+      }
+    };
+
+    // Helpers that start after the loop has finished find nothing to claim;
+    // they never touch the body, so it may safely reference this frame.
+    std::vector<Task> batch;
+    batch.reserve(helpers);
+    for (auto i = std::size_t(0); i < helpers; i++) {
+      batch.emplace_back([loop, body]() mutable { loop->Run(body); });
+    }
+    try {
+      ExecuteBatch(std::move(batch));
+    } catch (const std::runtime_error&) {
+      // A full queue rejected some helpers; their chunks are claimed by the
+      // others and this thread.
+    }
+
+    loop->Run(body);
+    loop->Wait();
+  }
 
  private:
-  void threadFunc();
+  struct alignas(64) WorkQueue {
+    RingBuffer<QueuedTask> tasks;
+    Synchronization::InternalMutex mx{"ThreadPoolExecutor::WorkQueue::mx"};
+  };
+
+  void threadFunc(std::size_t index);
+  void monitorFunc(const ThreadPoolOptions& options);
+  void resize(uint32_t nThreads, Synchronization::InternalLock& lock);
+  bool retire(std::size_t index);
+  bool admit(QueuedTask& task);
+  std::size_t reserve(std::size_t count);
+  bool evictOldest();
+  void dequeued();
+  bool runTask(Task& task);
+  void runInline(Task& task);
+  bool popTask(std::size_t index, QueuedTask& task);
+  bool waitForTask(std::size_t index, QueuedTask& task);
+  bool spin(std::size_t index, QueuedTask& task);
+  TaskQueue& submissionQueue();
+  void notify(std::size_t count = 1);
+
+  void pushLocal(std::size_t index, QueuedTask&& task);
+  bool popLocal(std::size_t index, QueuedTask& task);
+  bool steal(std::size_t index, QueuedTask& task);
 
  private:
-  bool running;
+  std::atomic<bool> running;
+  bool workStealing;
+
+  // Per-worker state is allocated for maxThreads slots up front; workers at
+  // index target and above exit. alive is guarded by resizeMx.
+  const uint32_t maxThreads;
+  std::atomic<uint32_t> target;
   std::vector<std::thread> workers;
-  std::queue<Task> tasks;
-  std::mutex mx;
-  std::condition_variable cv;
+  std::vector<bool> alive;
+  Synchronization::InternalMutex resizeMx{"ThreadPoolExecutor::resizeMx"};
+  Synchronization::InternalConditionVariable resizeCv;
+  std::thread monitor;
+
+  std::vector<std::vector<uint32_t>> workerCpus;
+  std::vector<std::size_t> workerNodes;
+  std::vector<std::unique_ptr<TaskQueue>> tasks;
+
+  std::vector<std::unique_ptr<WorkQueue>> localQueues;
+  std::atomic<uint64_t> pending;
+
+  const uint64_t maxQueued;
+  const RejectionPolicy rejection;
+  Synchronization::EventCount space;
+  std::atomic<uint64_t> blocked;
+  std::atomic<uint64_t> callerRuns;
+  std::atomic<uint64_t> rejected;
+  std::atomic<uint64_t> discarded;
+
+  const std::chrono::microseconds spinTime;
+  std::atomic<uint32_t> spinning;
+  Synchronization::EventCount idle;
+
+  std::unique_ptr<ExecutorMetrics> metrics;
 };
 }  // namespace Execution
 }  // namespace CppUtils
@@ -0,0 +1,136 @@
+#include "timerwheel.h"
+
+#include <algorithm>
+
+namespace CppUtils {
+namespace Execution {
+TimerWheel::TimerWheel(uint64_t now) : now(now), size(0) {
+  for (auto& level : levels) {
+    for (auto& slot : level) {
+      slot.prev = &slot;
+      slot.next = &slot;
+    }
+  }
+}
+
+void TimerWheel::Insert(TimerNode* node) {
+  if (node->linked) {
+    Remove(node);
+  }
+
+  node->deadline = std::max(node->deadline, now + 1);
+  link(node);
+  size++;
+}
+
+void TimerWheel::Remove(TimerNode* node) {
+  if (!node->linked) {
+    return;
+  }
+
+  unlink(node);
+  size--;
+}
+
+void TimerWheel::Advance(uint64_t tick, std::vector<TimerNode*>& expired) {
+  auto cascaded = std::vector<TimerNode*>();
+
+  while (now < tick) {
+    if (size == 0) {
+      now = tick;
+      break;
+    }
+
+    now++;
+
+    for (auto level = std::size_t(1); level < LEVELS; level++) {
+      if (((now >> (SLOT_BITS * level)) << (SLOT_BITS * level)) != now) {
+        break;
+      }
+
+      auto index = (now >> (SLOT_BITS * level)) & (SLOTS - 1);
+      drain(levels[level][index], cascaded);
+      for (auto* node : cascaded) {
+        link(node);
+      }
+      cascaded.clear();
+    }
+
+    auto before = expired.size();
+    drain(levels[0][now & (SLOTS - 1)], expired);
+    size -= expired.size() - before;
+  }
+}
+
+void TimerWheel::Reset(uint64_t tick) {
+  if (size == 0) {
+    now = tick;
+  }
+}
+
+void TimerWheel::Clear(std::vector<TimerNode*>& removed) {
+  for (auto& level : levels) {
+    for (auto& slot : level) {
+      drain(slot, removed);
+    }
+  }
+  size = 0;
+}
+
+uint64_t TimerWheel::NextTick() const {
+  auto tick = now + 1;
+  while ((tick & (SLOTS - 1)) != 0) {
+    auto& slot = levels[0][tick & (SLOTS - 1)];
+    if (slot.next != &slot) {
+      break;
+    }
+    tick++;
+  }
+  return tick;
+}
+
+uint64_t TimerWheel::Now() const { return now; }
+
+std::size_t TimerWheel::Size() const { return size; }
+
+void TimerWheel::link(TimerNode* node) {
+  auto delta = node->deadline - now;
+  auto level = std::size_t(0);
+
+  while (level + 1 < LEVELS &&
+         delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+
+  auto shift = SLOT_BITS * level;
+  auto deadline = node->deadline;
+  if (level + 1 == LEVELS) {
+    auto range = uint64_t(1) << (SLOT_BITS * LEVELS);
+    deadline = now + std::min(delta, range - (uint64_t(1) << shift));
+  }
+
+  auto& slot = levels[level][(deadline >> shift) & (SLOTS - 1)];
+  node->prev = slot.prev;
+  node->next = &slot;
+  slot.prev->next = node;
+  slot.prev = node;
+  node->linked = true;
+}
+
+void TimerWheel::unlink(TimerNode* node) {
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+  node->prev = nullptr;
+  node->next = nullptr;
+  node->linked = false;
+}
+
+void TimerWheel::drain(Slot& slot, std::vector<TimerNode*>& nodes) {
+  while (slot.next != &slot) {
+    auto* node = slot.next;
+    unlink(node);
+    nodes.emplace_back(node);
+  }
+}
+}  // namespace Execution
+}  // namespace CppUtils
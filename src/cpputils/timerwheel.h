@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CppUtils {
+namespace Execution {
+struct TimerNode {
+  uint64_t deadline = 0;
+
+  TimerNode* prev = nullptr;
+  TimerNode* next = nullptr;
+  bool linked = false;
+};
+
+// Hierarchical timing wheel: LEVELS wheels of SLOTS buckets, each level
+// SLOTS times coarser than the previous one. Insert and Remove are O(1);
+// entries of a coarse bucket are cascaded into finer levels when the clock
+// reaches them. Nodes are intrusive and owned by the caller. Not thread-safe.
+class TimerWheel {
+ public:
+  static constexpr std::size_t LEVELS = 4;
+  static constexpr std::size_t SLOT_BITS = 8;
+  static constexpr std::size_t SLOTS = std::size_t(1) << SLOT_BITS;
+
+  TimerWheel(uint64_t now = 0);
+
+  // Deadlines not after Now() fire on the next tick; deadlines beyond the
+  // wheel's range are clamped to its last bucket.
+  void Insert(TimerNode* node);
+  void Remove(TimerNode* node);
+
+  // Moves the clock forward to the given tick and appends the nodes that
+  // expired on the way, in deadline order.
+  void Advance(uint64_t tick, std::vector<TimerNode*>& expired);
+
+  // Jumps the clock without visiting the ticks in between; the wheel must be
+  // empty.
+  void Reset(uint64_t tick);
+
+  // Unlinks every node and appends it to the vector.
+  void Clear(std::vector<TimerNode*>& removed);
+
+  // The earliest tick Advance has work at: the first non-empty bucket of the
+  // finest level or the next cascade, whichever comes first.
+  uint64_t NextTick() const;
+
+  uint64_t Now() const;
+  std::size_t Size() const;
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+ private:
+  // Every slot is the sentinel of a circular list, so linked nodes always
+  // have both neighbours and can be unlinked without knowing their slot.
+  using Slot = TimerNode;
+
+  void link(TimerNode* node);
+  void unlink(TimerNode* node);
+  void drain(Slot& slot, std::vector<TimerNode*>& nodes);
+
+ private:
+  uint64_t now;
+  std::size_t size;
+  std::array<std::array<Slot, SLOTS>, LEVELS> levels;
+};
+}  // namespace Execution
+}  // namespace CppUtils
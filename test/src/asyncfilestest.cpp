@@ -0,0 +1,164 @@
+#include <cpputils/asyncfiles.h>
+#include <cpputils/files.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace CppUtils;
+
+namespace {
+void WriteReadAndStat(bool forceFallback) {
+  auto options = AsyncFilesOptions();
+  options.queueDepth = 8;
+  options.forceFallback = forceFallback;
+  auto files = AsyncFiles(options);
+
+  auto directory = fs::temp_directory_path() /
+                   ("cpputils-asyncfiles-" + std::to_string(getpid()));
+  Files::CreateDirectory(directory);
+
+  // More files than the ring holds, so submissions wait for completions.
+  const auto count = 40;
+  std::vector<int> fds;
+  std::vector<std::string> contents;
+  for (auto i = 0; i < count; i++) {
+    auto path = directory / ("file" + std::to_string(i));
+    fds.push_back(files.Open(path, O_CREAT | O_RDWR | O_TRUNC).Get());
+    contents.push_back(std::string(1000 + i * 100, char('a' + i % 26)));
+  }
+
+  std::vector<Execution::Future<std::size_t>> writes;
+  for (auto i = 0; i < count; i++) {
+    writes.push_back(
+        files.Write(fds[i], contents[i].data(), contents[i].size(), 0));
+  }
+  for (auto i = 0; i < count; i++) {
+    ASSERT_EQ(writes[i].Get(), contents[i].size());
+  }
+  files.Sync(fds[0]).Get();
+  files.Sync(fds[1], true).Get();
+
+  auto stat = files.Stat(directory / "file3").Get();
+  ASSERT_EQ(stat.stx_size, contents[3].size());
+
+  std::vector<std::string> buffers(count);
+  std::vector<ReadRequest> requests;
+  for (auto i = 0; i < count; i++) {
+    buffers[i].resize(contents[i].size());
+    requests.push_back({fds[i], buffers[i].data(), buffers[i].size(), 0});
+  }
+  auto reads = files.ReadBatch(requests);
+  for (auto i = 0; i < count; i++) {
+    ASSERT_EQ(reads[i].Get(), contents[i].size());
+    ASSERT_EQ(buffers[i], contents[i]);
+  }
+
+  auto fixed = std::vector<char>(4096);
+  files.RegisterBuffers({{fixed.data(), fixed.size()}});
+  ASSERT_EQ(files.ReadFixed(fds[5], 0, fixed.data() + 10, 100, 50).Get(),
+            std::size_t(100));
+  ASSERT_EQ(std::string(fixed.data() + 10, 100), contents[5].substr(50, 100));
+  ASSERT_THROW(files.ReadFixed(fds[5], 1, fixed.data(), 10, 0),
+               std::runtime_error);
+
+  for (auto fd : fds) {
+    files.Close(fd).Get();
+  }
+
+  ASSERT_THROW(files.Open(directory / "missing", O_RDONLY).Get(),
+               std::runtime_error);
+  ASSERT_THROW(files.Read(fds[0], buffers[0].data(), 1, 0).Get(),
+               std::runtime_error);
+
+  Files::Remove(directory);
+}
+}  // namespace
+
+TEST(AsyncFilesTest, IoUring) {
+  auto files = AsyncFiles();
+  if (!files.IsUsingIoUring()) {
+    GTEST_SKIP() << "io_uring is unavailable";
+  }
+  WriteReadAndStat(false);
+}
+
+TEST(AsyncFilesTest, ThreadPoolFallback) {
+  auto options = AsyncFilesOptions();
+  options.forceFallback = true;
+  ASSERT_FALSE(AsyncFiles(options).IsUsingIoUring());
+
+  WriteReadAndStat(true);
+}
+
+TEST(AsyncFilesTest, FallbackFinishesQueuedCallsOnDestruction) {
+  auto path = fs::temp_directory_path() /
+              ("cpputils-asyncfiles-queued-" + std::to_string(getpid()));
+  auto contents = std::string(4096, 'x');
+
+  std::vector<std::string> buffers(200, std::string(contents.size(), '\0'));
+  std::vector<Execution::Future<std::size_t>> reads;
+  {
+    auto options = AsyncFilesOptions();
+    options.forceFallback = true;
+    options.fallbackThreads = 1;
+    auto files = AsyncFiles(options);
+
+    auto fd = files.Open(path, O_CREAT | O_RDWR | O_TRUNC).Get();
+    files.Write(fd, contents.data(), contents.size(), 0).Get();
+
+    // Most of these are still queued when files goes out of scope.
+    for (auto& buffer : buffers) {
+      reads.push_back(files.Read(fd, buffer.data(), buffer.size(), 0));
+    }
+    files.Close(fd);
+  }
+
+  for (auto i = std::size_t(0); i < reads.size(); i++) {
+    ASSERT_EQ(reads[i].Get(), contents.size());
+    ASSERT_EQ(buffers[i], contents);
+  }
+  Files::Remove(path);
+}
+
+TEST(AsyncFilesTest, ContinuationSubmitsMoreThanTheRingHolds) {
+  auto options = AsyncFilesOptions();
+  options.queueDepth = 4;
+  auto files = AsyncFiles(options);
+  if (!files.IsUsingIoUring()) {
+    GTEST_SKIP() << "io_uring is unavailable";
+  }
+
+  auto path = fs::temp_directory_path() /
+              ("cpputils-asyncfiles-reaper-" + std::to_string(getpid()));
+  auto contents = std::string(512, 'r');
+  auto fd = files.Open(path, O_CREAT | O_RDWR | O_TRUNC).Get();
+  files.Write(fd, contents.data(), contents.size(), 0).Get();
+
+  // Without an executor the continuation runs on the reaper, which has to
+  // drain completions itself while it submits.
+  std::vector<std::string> buffers(256, std::string(contents.size(), '\0'));
+  std::vector<ReadRequest> requests;
+  for (auto& buffer : buffers) {
+    requests.push_back({fd, buffer.data(), buffer.size(), 0});
+  }
+
+  auto reads = std::make_shared<std::vector<Execution::Future<std::size_t>>>();
+  auto first = std::string(1, '\0');
+  files.Read(fd, first.data(), 1, 0)
+      .Then([&files, &requests, reads](const std::size_t&) {
+        *reads = files.ReadBatch(requests);
+      })
+      .Get();
+
+  for (auto i = std::size_t(0); i < reads->size(); i++) {
+    ASSERT_EQ((*reads)[i].Get(), contents.size());
+    ASSERT_EQ(buffers[i], contents);
+  }
+  files.Close(fd).Get();
+  Files::Remove(path);
+}
@@ -0,0 +1,93 @@
+#include <cpputils/coroutine.h>
+#include <cpputils/threadpoolexecutor.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <thread>
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+namespace {
+Coroutines::Task<int> Square(int value) { co_return value * value; }
+
+Coroutines::Task<std::thread::id> SumOnPool(Executor& executor, int& sum) {
+  co_await executor.Schedule();
+
+  for (auto i = 1; i <= 3; i++) {
+    sum += co_await Square(i);
+  }
+  co_return std::this_thread::get_id();
+}
+
+Coroutines::Task<int> AddOne(Future<int> future) {
+  co_return co_await future + 1;
+}
+
+Coroutines::Task<void> Fail() {
+  co_await std::suspend_never();
+  throw std::runtime_error("failed");
+}
+
+Coroutines::Task<int> AfterLatch(Synchronization::CountDownLatch& latch,
+                                 const int& value) {
+  co_await latch;
+  co_return value;
+}
+
+// Each await of the open latch would nest a resume if it suspended.
+Coroutines::Task<int> AwaitOpenLatch(Synchronization::CountDownLatch& latch,
+                                     int times) {
+  auto count = 0;
+  for (auto i = 0; i < times; i++) {
+    co_await latch;
+    count++;
+  }
+  co_return count;
+}
+}  // namespace
+
+TEST(CoroutineTest, ScheduleResumesOnExecutor) {
+  auto executor = ThreadPoolExecutor(2);
+  auto sum = 0;
+
+  auto worker = Coroutines::Spawn(executor, SumOnPool(executor, sum)).Get();
+
+  ASSERT_NE(worker, std::this_thread::get_id());
+  ASSERT_EQ(sum, 14);
+}
+
+TEST(CoroutineTest, AwaitsFuturesAndPropagatesExceptions) {
+  auto executor = ThreadPoolExecutor(2);
+  auto promise = Promise<int>(&executor);
+
+  auto result = Coroutines::Spawn(executor, AddOne(promise.GetFuture()));
+  promise.SetValue(41);
+  ASSERT_EQ(result.Get(), 42);
+
+  auto failed = Coroutines::Spawn(executor, Fail());
+  ASSERT_THROW(failed.Get(), std::runtime_error);
+}
+
+TEST(CoroutineTest, AwaitsLatch) {
+  auto executor = ThreadPoolExecutor(2);
+  auto latch = Synchronization::CountDownLatch(2);
+  auto value = 0;
+
+  auto result = Coroutines::Spawn(executor, AfterLatch(latch, value));
+  value = 7;
+  latch.CountDown();
+  ASSERT_FALSE(result.IsReady());
+  latch.CountDown();
+
+  ASSERT_EQ(result.Get(), 7);
+}
+
+TEST(CoroutineTest, AwaitingReadyLatchDoesNotNest) {
+  auto executor = ThreadPoolExecutor(1);
+  auto latch = Synchronization::CountDownLatch(1);
+  latch.CountDown();
+
+  auto result = Coroutines::Spawn(executor, AwaitOpenLatch(latch, 1000000));
+  ASSERT_EQ(result.Get(), 1000000);
+}
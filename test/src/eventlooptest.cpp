@@ -0,0 +1,140 @@
+#include <cpputils/countdownlatch.h>
+#include <cpputils/eventloopexecutor.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+TEST(EventLoopTest, ExecuteRunsTasksInOrderOnLoopThread) {
+  auto loop = EventLoopExecutor();
+  auto latch = Synchronization::CountDownLatch(1);
+  auto order = std::vector<int>();
+  auto onLoop = std::atomic<bool>(true);
+
+  for (auto i = 0; i < 1000; i++) {
+    loop.Execute([&, i] {
+      onLoop = onLoop && loop.IsInLoopThread();
+      order.push_back(i);
+      if (i == 999) {
+        latch.CountDown();
+      }
+    });
+  }
+  latch.Await();
+
+  ASSERT_TRUE(onLoop);
+  ASSERT_FALSE(loop.IsInLoopThread());
+  for (auto i = 0; i < 1000; i++) {
+    ASSERT_EQ(order[i], i);
+  }
+}
+
+TEST(EventLoopTest, DispatchesPipeReadiness) {
+  auto loop = EventLoopExecutor();
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+
+  auto latch = Synchronization::CountDownLatch(1);
+  auto received = std::string();
+
+  loop.OnReadable(fds[0], [&] {
+    char buffer[64];
+    auto count = read(fds[0], buffer, sizeof(buffer));
+    if (count <= 0) {
+      loop.Remove(fds[0]);
+      latch.CountDown();
+      return;
+    }
+    received.append(buffer, static_cast<std::size_t>(count));
+  });
+
+  ASSERT_EQ(write(fds[1], "hello ", 6), 6);
+  ASSERT_EQ(write(fds[1], "loop", 4), 4);
+  close(fds[1]);
+
+  latch.Await();
+  close(fds[0]);
+  ASSERT_EQ(received, "hello loop");
+}
+
+TEST(EventLoopTest, DispatchesSocketWritability) {
+  auto loop = EventLoopExecutor();
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  auto latch = Synchronization::CountDownLatch(2);
+  loop.OnWritable(fds[0], [&] {
+    ASSERT_EQ(write(fds[0], "x", 1), 1);
+    loop.OnWritable(fds[0], nullptr);
+    latch.CountDown();
+  });
+  loop.OnReadable(fds[1], [&] {
+    char value;
+    ASSERT_EQ(read(fds[1], &value, 1), 1);
+    ASSERT_EQ(value, 'x');
+    loop.Remove(fds[1]);
+    latch.CountDown();
+  });
+
+  latch.Await();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(EventLoopTest, TimersFireAndCancel) {
+  auto loop = EventLoopExecutor();
+  auto latch = Synchronization::CountDownLatch(3);
+  auto ticks = std::atomic<int>(0);
+  auto cancelledRan = std::atomic<bool>(false);
+
+  auto cancelled = loop.Schedule(std::chrono::milliseconds(20),
+                                 [&] { cancelledRan = true; });
+  auto periodic = loop.ScheduleAtFixedRate(
+      std::chrono::milliseconds(5), std::chrono::milliseconds(5), [&] {
+        if (++ticks <= 3) {
+          latch.CountDown();
+        }
+      });
+  ASSERT_TRUE(cancelled.Cancel());
+
+  latch.Await();
+  ASSERT_TRUE(periodic.Cancel());
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+  ASSERT_FALSE(cancelledRan);
+  ASSERT_FALSE(periodic.Cancel());
+}
+
+TEST(EventLoopTest, FixedRateSkipsMissedRuns) {
+  using Clock = std::chrono::steady_clock;
+
+  auto loop = EventLoopExecutor();
+  auto latch = Synchronization::CountDownLatch(2);
+  auto times = std::vector<Clock::time_point>();
+
+  auto periodic = loop.ScheduleAtFixedRate(
+      std::chrono::milliseconds(0), std::chrono::milliseconds(10), [&] {
+        if (times.size() == 2) {
+          return;
+        }
+        if (times.empty()) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        times.emplace_back(Clock::now());
+        latch.CountDown();
+      });
+
+  latch.Await();
+  periodic.Cancel();
+
+  // Catching up would run the second time right after the first.
+  ASSERT_GE(times[1] - times[0], std::chrono::milliseconds(5));
+}
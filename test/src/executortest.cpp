@@ -1,9 +1,19 @@
+#include <cpputils/cachedthreadpoolexecutor.h>
+#include <cpputils/countdownlatch.h>
+#include <cpputils/mpmcqueue.h>
+#include <cpputils/serialexecutor.h>
 #include <cpputils/threadpertaskexecutor.h>
 #include <cpputils/threadpoolexecutor.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 using namespace CppUtils;
 using namespace CppUtils::Execution;
@@ -18,3 +28,634 @@ TEST(ExecutorTest, ThreadPerTaskLaunch) {
         [] { std::this_thread::sleep_for(std::chrono::seconds(1)); });
   }
 }
+
+TEST(ExecutorTest, WorkStealingRunsNestedTasks) {
+  auto options = ThreadPoolOptions();
+  options.threads = 4;
+  options.workStealing = true;
+
+  // The test thread owns the pool: a task holding the last reference would
+  // run the destructor on a worker, which then joins itself.
+  auto executor = std::make_unique<ThreadPoolExecutor>(options);
+  auto* pool = executor.get();
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(1000);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  for (int i = 0; i < 100; i++) {
+    executor->Execute([pool, latch, counter] {
+      for (int j = 0; j < 10; j++) {
+        pool->Execute([latch, counter] {
+          counter->fetch_add(1);
+          latch->CountDown();
+        });
+      }
+    });
+  }
+
+  latch->Await();
+
+  ASSERT_EQ(counter->load(), 1000);
+}
+
+TEST(ExecutorTest, MPMCQueueKeepsEveryItem) {
+  auto queue = std::make_shared<MPMCQueue<int>>(64);
+  auto sum = std::make_shared<std::atomic<long long>>(0);
+  auto popped = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < 4; p++) {
+    threads.emplace_back([queue, p] {
+      for (int i = 1; i <= 10000; i++) {
+        while (!queue->TryPush(i + p * 10000)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (int c = 0; c < 4; c++) {
+    threads.emplace_back([queue, sum, popped] {
+      int value;
+      while (popped->load() < 40000) {
+        if (queue->TryPop(value)) {
+          sum->fetch_add(value);
+          popped->fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(queue->Capacity(), 64u);
+  ASSERT_EQ(sum->load(), 40000ll * 40001ll / 2);
+}
+
+TEST(ExecutorTest, LockFreeQueueRunsAllTasks) {
+  auto options = ThreadPoolOptions();
+  options.threads = 4;
+  options.queue = TaskQueueType::LockFree;
+  options.queueCapacity = 16;
+
+  auto executor = std::make_shared<ThreadPoolExecutor>(options);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(1000);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  for (int i = 0; i < 1000; i++) {
+    executor->Execute([latch, counter] {
+      counter->fetch_add(1);
+      latch->CountDown();
+    });
+  }
+
+  latch->Await();
+
+  ASSERT_EQ(counter->load(), 1000);
+}
+
+TEST(ExecutorTest, LockFreeQueueSurvivesNestedOverflow) {
+  auto options = ThreadPoolOptions();
+  options.threads = 2;
+  options.queue = TaskQueueType::LockFree;
+  options.queueCapacity = 16;
+
+  // Every worker fills the ring from inside a task; waiting for room there
+  // would leave nobody to pop.
+  auto executor = std::make_unique<ThreadPoolExecutor>(options);
+  auto* pool = executor.get();
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(8 * 300);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  for (int i = 0; i < 8; i++) {
+    executor->Execute([pool, latch, counter] {
+      for (int j = 0; j < 100; j++) {
+        pool->Execute([latch, counter] {
+          counter->fetch_add(1);
+          latch->CountDown();
+        });
+      }
+
+      std::vector<Task> batch;
+      for (int j = 0; j < 200; j++) {
+        batch.emplace_back([latch, counter] {
+          counter->fetch_add(1);
+          latch->CountDown();
+        });
+      }
+      pool->ExecuteBatch(std::move(batch));
+    });
+  }
+
+  ASSERT_TRUE(latch->AwaitFor(std::chrono::seconds(30)));
+  ASSERT_EQ(counter->load(), 8 * 300);
+  ASSERT_GT(executor->GetStats().callerRuns, 0u);
+}
+
+TEST(ExecutorTest, TaskStoresMoveOnlyAndLargeCallables) {
+  auto value = std::make_unique<int>(21);
+  auto small = Task([value = std::move(value)] { *value *= 2; });
+
+  auto padding = std::array<char, 2 * Task::BUFFER_SIZE>();
+  auto counter = std::make_shared<int>(0);
+  auto large = Task([padding, counter] { *counter += padding.size(); });
+
+  auto moved = std::move(large);
+  moved();
+  small();
+
+  ASSERT_FALSE(static_cast<bool>(large));
+  ASSERT_EQ(*counter, static_cast<int>(padding.size()));
+  ASSERT_THROW(large(), std::bad_function_call);
+}
+
+TEST(ExecutorTest, ExecuteAcceptsMoveOnlyTasks) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(2);
+  auto sum = std::make_shared<std::atomic<int>>(0);
+
+  auto first = std::make_unique<int>(1);
+  executor->Execute([first = std::move(first), latch, sum] {
+    sum->fetch_add(*first);
+    latch->CountDown();
+  });
+
+  auto second = std::make_unique<int>(2);
+  auto future = executor->Submit([second = std::move(second), latch, sum] {
+    sum->fetch_add(*second);
+    latch->CountDown();
+  });
+
+  latch->Await();
+  future.Get();
+
+  ASSERT_EQ(sum->load(), 3);
+}
+
+TEST(ExecutorTest, ExecuteBatchRunsAllTasks) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(100);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<Task> batch;
+  for (int i = 0; i < 100; i++) {
+    batch.emplace_back([latch, counter] {
+      counter->fetch_add(1);
+      latch->CountDown();
+    });
+  }
+  executor->ExecuteBatch(std::move(batch));
+
+  latch->Await();
+
+  ASSERT_EQ(counter->load(), 100);
+}
+
+TEST(ExecutorTest, ParallelForVisitsEveryIndexOnce) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  std::vector<std::atomic<int>> visits(100000);
+
+  executor->ParallelFor(0, 100000, 64, [&visits](int i) { visits[i]++; });
+
+  for (auto& visit : visits) {
+    ASSERT_EQ(visit.load(), 1);
+  }
+}
+
+TEST(ExecutorTest, ParallelForRethrowsException) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+
+  auto loop = [executor] {
+    executor->ParallelFor(0, 1000, 1, [](int i) {
+      if (i == 500) {
+        throw std::runtime_error("failure");
+      }
+    });
+  };
+
+  ASSERT_THROW(loop(), std::runtime_error);
+}
+
+TEST(ExecutorTest, CachedThreadPoolReusesIdleThreads) {
+  auto executor = std::make_shared<CachedThreadPoolExecutor>(
+      4, std::chrono::milliseconds(100));
+
+  auto hardware = std::max(std::thread::hardware_concurrency(), 1u);
+  ASSERT_EQ(executor->GetConcurrency(), std::min(4u, hardware));
+  ASSERT_EQ(CachedThreadPoolExecutor().GetConcurrency(),
+            std::min(256u, hardware));
+
+  for (int i = 0; i < 20; i++) {
+    executor->Submit([] {}).Get();
+    while (executor->GetIdleThreadCount() == 0) {
+      std::this_thread::yield();
+    }
+  }
+  ASSERT_EQ(executor->GetThreadCount(), 1u);
+
+  while (executor->GetThreadCount() != 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+TEST(ExecutorTest, CachedThreadPoolRespectsCapAndWaitsForTasks) {
+  auto counter = std::make_shared<std::atomic<int>>(0);
+  {
+    auto executor = std::make_shared<CachedThreadPoolExecutor>(4);
+
+    for (int i = 0; i < 50; i++) {
+      executor->Execute([counter] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        counter->fetch_add(1);
+      });
+    }
+    ASSERT_LE(executor->GetThreadCount(), 4u);
+  }
+  ASSERT_EQ(counter->load(), 50);
+}
+
+TEST(ExecutorTest, CpuTopologyParsesCpuLists) {
+  auto cpus = CpuTopology::ParseCpuList("0-3,8,10-11");
+
+  ASSERT_EQ(cpus, (std::vector<uint32_t>{0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_TRUE(CpuTopology::ParseCpuList("").empty());
+  ASSERT_THROW(CpuTopology::ParseCpuList("a-b"), std::runtime_error);
+}
+
+TEST(ExecutorTest, PlacementPoliciesRunTasks) {
+  auto& topology = CpuTopology::Get();
+  ASSERT_FALSE(topology.GetCpus().empty());
+  ASSERT_FALSE(topology.GetNodes().empty());
+
+  auto placements = {WorkerPlacement::Compact, WorkerPlacement::Scatter,
+                     WorkerPlacement::Explicit, WorkerPlacement::NumaNodes};
+
+  for (auto placement : placements) {
+    auto options = ThreadPoolOptions();
+    options.threads = 4;
+    options.placement = placement;
+    options.cpus = {topology.GetCpus().front().id};
+
+    auto executor = std::make_shared<ThreadPoolExecutor>(options);
+    auto sum = std::make_shared<std::atomic<int>>(0);
+
+    executor->ParallelFor(0, 1000, 10, [sum](int i) { sum->fetch_add(i); });
+
+    ASSERT_EQ(sum->load(), 499500);
+  }
+}
+
+TEST(ExecutorTest, LatencyHistogramBucketsAreLogLinear) {
+  for (auto value : {0ull, 7ull, 8ull, 100ull, 12345ull, 1ull << 40}) {
+    auto index = LatencyHistogram::IndexOf(value);
+    ASSERT_LE(LatencyHistogram::LowerBoundOf(index), value);
+    ASSERT_GE(LatencyHistogram::UpperBoundOf(index), value);
+    ASSERT_LE(LatencyHistogram::UpperBoundOf(index) -
+                  LatencyHistogram::LowerBoundOf(index),
+              value / 8);
+  }
+
+  auto histogram = std::make_unique<LatencyHistogram>();
+  for (auto value = 1ull; value <= 1000ull; value++) {
+    histogram->Record(value);
+  }
+
+  auto snapshot = HistogramSnapshot();
+  histogram->AddTo(snapshot);
+
+  ASSERT_EQ(snapshot.GetCount(), 1000ull);
+  ASSERT_DOUBLE_EQ(snapshot.GetMean(), 500.5);
+  ASSERT_NEAR(snapshot.GetPercentile(50.0), 500.0, 500.0 / 8);
+  ASSERT_GE(snapshot.GetPercentile(100.0), 1000ull);
+}
+
+TEST(ExecutorTest, ThreadPoolCollectsStats) {
+  auto options = ThreadPoolOptions();
+  options.threads = 4;
+  options.collectStats = true;
+
+  auto executor = std::make_shared<ThreadPoolExecutor>(options);
+  for (int i = 0; i < 100; i++) {
+    executor->Execute([i] {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      if (i % 10 == 0) {
+        throw std::runtime_error("failure");
+      }
+    });
+  }
+
+  while (executor->GetStats().completed < 100) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  auto stats = executor->GetStats();
+  ASSERT_EQ(stats.started, 100ull);
+  ASSERT_EQ(stats.failed, 10ull);
+  ASSERT_EQ(stats.queued, 0ull);
+  ASSERT_EQ(stats.threads, 4u);
+  ASSERT_EQ(stats.waitTime.GetCount(), 100ull);
+  ASSERT_EQ(stats.runTime.GetCount(), 100ull);
+  ASSERT_GE(stats.runTime.GetPercentile(50.0), 100000ull);
+  ASSERT_GT(stats.utilization, 0.0);
+  // Counters read on different cores must never wrap into huge waits.
+  ASSERT_LT(stats.waitTime.GetPercentile(100.0), 60'000'000'000ull);
+  ASSERT_EQ(ExecutorMetrics::Elapsed(10, 4), 0ull);
+  ASSERT_EQ(ExecutorMetrics::Elapsed(4, 10), 6ull);
+
+  executor->ResetStats();
+  stats = executor->GetStats();
+  ASSERT_EQ(stats.completed, 0ull);
+  ASSERT_EQ(stats.runTime.GetCount(), 0ull);
+}
+
+TEST(ExecutorTest, ThreadPerTaskCollectsStats) {
+  auto executor = std::make_shared<ThreadPerTaskExecutor>(true);
+  for (int i = 0; i < 10; i++) {
+    executor->Execute([] {});
+  }
+
+  while (executor->GetStats().completed < 10) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(executor->GetStats().waitTime.GetCount(), 10ull);
+}
+
+TEST(ExecutorTest, SerialExecutorRunsTasksInOrder) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  auto strand = std::make_shared<SerialExecutor>(*executor, 16);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(1000);
+
+  // Deliberately not atomic: the strand must serialize the tasks.
+  auto order = std::make_shared<std::vector<int>>();
+  auto inside = std::make_shared<std::atomic<int>>(0);
+  auto overlapped = std::make_shared<std::atomic<bool>>(false);
+
+  for (int i = 0; i < 1000; i++) {
+    strand->Execute([strand, latch, order, inside, overlapped, i] {
+      if (inside->fetch_add(1) != 0 || !strand->IsRunningInThisThread()) {
+        overlapped->store(true);
+      }
+      order->emplace_back(i);
+      inside->fetch_sub(1);
+      latch->CountDown();
+    });
+  }
+
+  latch->Await();
+
+  ASSERT_FALSE(overlapped->load());
+  ASSERT_FALSE(strand->IsRunningInThisThread());
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ((*order)[i], i);
+  }
+}
+
+TEST(ExecutorTest, SerialExecutorsShareOnePool) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  std::vector<std::shared_ptr<SerialExecutor>> strands;
+  std::vector<Future<int>> futures;
+
+  for (int i = 0; i < 8; i++) {
+    strands.emplace_back(std::make_shared<SerialExecutor>(*executor));
+  }
+
+  auto counters = std::make_shared<std::array<int, 8>>();
+  for (int i = 0; i < 8000; i++) {
+    futures.emplace_back(strands[i % 8]->Submit(
+        [counters, i] { return ++(*counters)[i % 8]; }));
+  }
+
+  for (int i = 0; i < 8000; i++) {
+    ASSERT_EQ(futures[i].Get(), i / 8 + 1);
+  }
+}
+
+namespace {
+// Forwards to a pool unless told to refuse.
+class RefusingExecutor : public Executor {
+ public:
+  explicit RefusingExecutor(Executor& target) : target(target) {}
+
+  void Execute(Task&& task) override {
+    if (refuse.load()) {
+      throw std::runtime_error("refused");
+    }
+    target.Execute(std::move(task));
+  }
+
+  uint32_t GetConcurrency() const override {
+    return target.GetConcurrency();
+  }
+
+  std::atomic<bool> refuse{false};
+
+ private:
+  Executor& target;
+};
+}  // namespace
+
+TEST(ExecutorTest, SerialExecutorSurvivesRefusedDrain) {
+  auto pool = std::make_shared<ThreadPoolExecutor>(2);
+  auto target = RefusingExecutor(*pool);
+  auto strand = std::make_shared<SerialExecutor>(target);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(2);
+  auto order = std::make_shared<std::vector<int>>();
+
+  target.refuse.store(true);
+  ASSERT_NO_THROW(strand->Execute([latch, order] {
+    order->emplace_back(0);
+    latch->CountDown();
+  }));
+
+  target.refuse.store(false);
+  strand->Execute([latch, order] {
+    order->emplace_back(1);
+    latch->CountDown();
+  });
+
+  ASSERT_TRUE(latch->AwaitFor(std::chrono::seconds(10)));
+  ASSERT_EQ(*order, std::vector<int>({0, 1}));
+}
+
+TEST(ExecutorTest, IdleWorkersPickUpBursts) {
+  for (auto spinTime : {0, 50, 1000}) {
+    auto options = ThreadPoolOptions();
+    options.threads = 4;
+    options.spinTime = std::chrono::microseconds(spinTime);
+
+    auto executor = std::make_shared<ThreadPoolExecutor>(options);
+    auto counter = std::make_shared<std::atomic<int>>(0);
+
+    for (int burst = 0; burst < 20; burst++) {
+      for (int i = 0; i < 50; i++) {
+        executor->Execute([counter] { counter->fetch_add(1); });
+      }
+      while (counter->load() != (burst + 1) * 50) {
+        std::this_thread::yield();
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+}
+
+TEST(ExecutorTest, ResizeKeepsRunningTasks) {
+  auto options = ThreadPoolOptions();
+  options.threads = 2;
+  options.maxThreads = 8;
+  options.workStealing = true;
+
+  auto executor = std::make_unique<ThreadPoolExecutor>(options);
+  auto* pool = executor.get();
+  auto counter = std::make_shared<std::atomic<int>>(0);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(400);
+
+  for (auto size : {8u, 1u, 4u, 2u}) {
+    executor->Resize(size);
+    ASSERT_EQ(executor->GetThreadCount(), size);
+
+    for (int i = 0; i < 100; i++) {
+      executor->Execute([pool, counter, latch] {
+        pool->Execute([counter, latch] {
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+          counter->fetch_add(1);
+          latch->CountDown();
+        });
+      });
+    }
+  }
+
+  latch->Await();
+
+  ASSERT_EQ(counter->load(), 400);
+  ASSERT_THROW(executor->Resize(0), std::runtime_error);
+  ASSERT_THROW(executor->Resize(9), std::runtime_error);
+}
+
+TEST(ExecutorTest, AutoscaleFollowsLoad) {
+  auto options = ThreadPoolOptions();
+  options.threads = 1;
+  options.maxThreads = 4;
+  options.autoscale = true;
+  options.scaleInterval = std::chrono::milliseconds(5);
+  options.idleTimeout = std::chrono::milliseconds(20);
+
+  auto executor = std::make_shared<ThreadPoolExecutor>(options);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(200);
+
+  for (int i = 0; i < 200; i++) {
+    executor->Execute([latch] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      latch->CountDown();
+    });
+  }
+
+  while (executor->GetThreadCount() < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  latch->Await();
+
+  while (executor->GetThreadCount() > 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+TEST(ExecutorTest, RejectionPoliciesBoundTheQueue) {
+  auto policies = {RejectionPolicy::Block, RejectionPolicy::CallerRuns,
+                   RejectionPolicy::Reject, RejectionPolicy::DiscardOldest};
+
+  for (auto policy : policies) {
+    auto options = ThreadPoolOptions();
+    options.threads = 1;
+    options.maxQueued = 4;
+    options.rejection = policy;
+
+    auto executor = std::make_shared<ThreadPoolExecutor>(options);
+    auto gate = std::make_shared<std::atomic<bool>>(false);
+    auto started = std::make_shared<std::atomic<bool>>(false);
+    auto counter = std::make_shared<std::atomic<int>>(0);
+
+    executor->Execute([gate, started] {
+      started->store(true);
+      while (!gate->load()) {
+        std::this_thread::yield();
+      }
+    });
+    while (!started->load()) {
+      std::this_thread::yield();
+    }
+
+    auto submitter = std::thread([executor, counter] {
+      for (int i = 0; i < 10; i++) {
+        try {
+          executor->Execute([counter] { counter->fetch_add(1); });
+        } catch (const std::runtime_error&) {
+        }
+      }
+    });
+
+    if (policy == RejectionPolicy::Block) {
+      while (executor->GetStats().blocked == 0) {
+        std::this_thread::yield();
+      }
+      ASSERT_LE(executor->GetStats().queued, 4ull);
+    } else {
+      submitter.join();
+    }
+    gate->store(true);
+    if (submitter.joinable()) {
+      submitter.join();
+    }
+
+    auto expected = policy == RejectionPolicy::Reject ||
+                            policy == RejectionPolicy::DiscardOldest
+                        ? 4
+                        : 10;
+    while (counter->load() < expected) {
+      std::this_thread::yield();
+    }
+
+    auto stats = executor->GetStats();
+    switch (policy) {
+      case RejectionPolicy::Block:
+        ASSERT_GE(stats.blocked, 1ull);
+        break;
+      case RejectionPolicy::CallerRuns:
+        ASSERT_EQ(stats.callerRuns, 6ull);
+        break;
+      case RejectionPolicy::Reject:
+        ASSERT_EQ(stats.rejected, 6ull);
+        break;
+      case RejectionPolicy::DiscardOldest:
+        ASSERT_EQ(stats.discarded, 6ull);
+        break;
+    }
+  }
+}
+
+TEST(ExecutorTest, DiscardOldestEvictsFromWorkerDeques) {
+  auto options = ThreadPoolOptions();
+  options.threads = 1;
+  options.workStealing = true;
+  options.maxQueued = 4;
+  options.rejection = RejectionPolicy::DiscardOldest;
+
+  auto executor = std::make_unique<ThreadPoolExecutor>(options);
+  auto* pool = executor.get();
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(1);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  // Everything the only worker submits lands in its own deque.
+  executor->Execute([pool, latch, counter] {
+    for (int i = 0; i < 10; i++) {
+      pool->Execute([counter] { counter->fetch_add(1); });
+    }
+    latch->CountDown();
+  });
+
+  ASSERT_TRUE(latch->AwaitFor(std::chrono::seconds(10)));
+  while (counter->load() < 4) {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(executor->GetStats().discarded, 6ull);
+}
@@ -0,0 +1,105 @@
+#include <cpputils/fiberexecutor.h>
+#include <cpputils/fibersync.h>
+#include <cpputils/threadpoolexecutor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+TEST(FiberTest, BlockedFibersFreeTheirWorkers) {
+  auto pool = ThreadPoolExecutor(2);
+  auto options = FiberOptions();
+  options.stackSize = 16 * 1024;
+  auto fibers = FiberExecutor(pool, options);
+
+  const auto count = 10000;
+  auto gate = Synchronization::FiberLatch(1);
+  auto done = Synchronization::FiberLatch(count);
+  auto waiting = std::atomic<int>(0);
+
+  for (auto i = 0; i < count; i++) {
+    fibers.Execute([&] {
+      waiting++;
+      gate.Await();
+      done.CountDown();
+    });
+  }
+
+  while (waiting < count) {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(fibers.GetFiberCount(), std::size_t(count));
+
+  gate.CountDown();
+  done.Await();
+}
+
+TEST(FiberTest, MutexAndConditionVariable) {
+  auto pool = ThreadPoolExecutor(2);
+  auto fibers = FiberExecutor(pool);
+
+  auto mx = Synchronization::FiberMutex();
+  auto cv = Synchronization::FiberConditionVariable();
+  auto done = Synchronization::FiberLatch(64);
+  auto counter = 0;
+  auto turn = 0;
+
+  for (auto i = 0; i < 64; i++) {
+    fibers.Execute([&, i] {
+      for (auto j = 0; j < 100; j++) {
+        auto lock = std::unique_lock<Synchronization::FiberMutex>(mx);
+        auto value = counter;
+        FiberExecutor::Yield();
+        counter = value + 1;
+      }
+
+      // Finish in index order.
+      auto lock = std::unique_lock<Synchronization::FiberMutex>(mx);
+      cv.Wait(lock, [&] { return turn == i; });
+      turn++;
+      cv.NotifyAll();
+      done.CountDown();
+    });
+  }
+
+  done.Await();
+  ASSERT_EQ(counter, 6400);
+  ASSERT_EQ(turn, 64);
+}
+
+TEST(FiberTest, RefusedResumesAreRetried) {
+  for (auto policy :
+       {RejectionPolicy::Reject, RejectionPolicy::DiscardOldest}) {
+    auto options = ThreadPoolOptions();
+    options.threads = 2;
+    options.maxQueued = 4;
+    options.rejection = policy;
+    auto pool = ThreadPoolExecutor(options);
+    auto fibers = FiberExecutor(pool);
+
+    const auto count = 32;
+    auto gate = Synchronization::FiberLatch(1);
+    auto done = Synchronization::FiberLatch(count);
+    auto waiting = std::atomic<int>(0);
+
+    // Started one at a time so the bounded queue takes every new fiber.
+    for (auto i = 0; i < count; i++) {
+      fibers.Execute([&] {
+        waiting++;
+        gate.Await();
+        done.CountDown();
+      });
+      while (waiting <= i) {
+        std::this_thread::yield();
+      }
+    }
+
+    // Waking them all at once overflows the queue.
+    gate.CountDown();
+    done.Await();
+    ASSERT_GT(pool.GetStats().rejected + pool.GetStats().discarded, 0ull);
+  }
+}
@@ -0,0 +1,153 @@
+#include <cpputils/countdownlatch.h>
+#include <cpputils/threadpoolexecutor.h>
+#include <gtest/gtest.h>
+
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace CppUtils::Execution;
+using CppUtils::Synchronization::CountDownLatch;
+
+TEST(FutureTest, SubmitReturnsResult) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+
+  auto future = executor->Submit([] { return 6 * 7; });
+
+  ASSERT_EQ(future.Get(), 42);
+}
+
+TEST(FutureTest, ThenChainsOnExecutor) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+
+  auto future = executor->Submit([] { return 20; })
+                    .Then([](int value) { return value + 1; })
+                    .Then([](int value) { return std::to_string(value * 2); });
+
+  ASSERT_EQ(future.Get(), "42");
+}
+
+TEST(FutureTest, ExceptionSkipsContinuation) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto called = std::make_shared<std::atomic<bool>>(false);
+
+  auto future =
+      executor->Submit([]() -> int { throw std::runtime_error("failure"); })
+          .Then([called](int value) {
+            called->store(true);
+            return value;
+          });
+
+  ASSERT_THROW(future.Get(), std::runtime_error);
+  ASSERT_FALSE(called->load());
+}
+
+TEST(FutureTest, WhenAllCollectsResults) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+
+  std::vector<Future<int>> futures;
+  for (int i = 0; i < 100; i++) {
+    futures.emplace_back(executor->Submit([i] { return i; }));
+  }
+
+  auto sum = WhenAll(futures).Then([](const std::vector<int>& values) {
+    auto result = 0;
+    for (auto value : values) {
+      result += value;
+    }
+    return result;
+  });
+
+  ASSERT_EQ(sum.Get(), 4950);
+}
+
+TEST(FutureTest, WhenAllOfVoid) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<Future<void>> futures;
+  for (int i = 0; i < 10; i++) {
+    futures.emplace_back(
+        executor->Submit([counter] { counter->fetch_add(1); }));
+  }
+
+  WhenAll(futures).Get();
+
+  ASSERT_EQ(counter->load(), 10);
+}
+
+TEST(FutureTest, WhenAnyReturnsFirstCompleted) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto promise = Promise<int>();
+
+  std::vector<Future<int>> futures{promise.GetFuture(),
+                                   executor->Submit([] { return 1; })};
+
+  auto index = WhenAny(futures).Get();
+
+  ASSERT_EQ(index, 1u);
+  ASSERT_EQ(futures[index].Get(), 1);
+
+  promise.SetValue(0);
+}
+
+TEST(FutureTest, DroppedPromiseBreaksFuture) {
+  auto future = Future<int>();
+  {
+    auto promise = Promise<int>();
+    auto copy = promise;
+    future = promise.GetFuture();
+  }
+
+  ASSERT_TRUE(future.IsReady());
+  ASSERT_THROW(future.Get(), std::future_error);
+
+  auto satisfied = Future<int>();
+  {
+    auto promise = Promise<int>();
+    satisfied = promise.GetFuture();
+    promise.SetValue(42);
+  }
+  ASSERT_EQ(satisfied.Get(), 42);
+}
+
+TEST(FutureTest, RejectedContinuationFailsFuture) {
+  auto options = ThreadPoolOptions();
+  options.threads = 1;
+  options.maxQueued = 1;
+  options.rejection = RejectionPolicy::Reject;
+  auto executor = std::make_shared<ThreadPoolExecutor>(options);
+
+  // The worker is busy and the only queue slot is taken.
+  auto release = std::make_shared<CountDownLatch>(1);
+  auto started = std::make_shared<CountDownLatch>(1);
+  executor->Execute([release, started] {
+    started->CountDown();
+    release->Await();
+  });
+  started->Await();
+  executor->Execute([] {});
+
+  auto promise = Promise<int>();
+  auto next =
+      promise.GetFuture().Then(*executor, [](int value) { return value; });
+
+  ASSERT_NO_THROW(promise.SetValue(1));
+  ASSERT_THROW(next.Get(), std::runtime_error);
+
+  release->CountDown();
+}
+
+TEST(FutureTest, ThenTakesMoveOnlyContinuation) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto factor = std::make_unique<int>(2);
+
+  auto future = executor->Submit([] { return 21; })
+                    .Then([factor = std::move(factor)](int value) {
+                      return value * *factor;
+                    });
+
+  ASSERT_EQ(future.Get(), 42);
+}
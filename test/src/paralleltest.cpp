@@ -0,0 +1,117 @@
+#include <cpputils/parallel.h>
+#include <cpputils/threadpoolexecutor.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+namespace {
+std::vector<uint32_t> randomValues(std::size_t size) {
+  auto engine = std::mt19937(static_cast<uint32_t>(size));
+  std::vector<uint32_t> values(size);
+  for (auto& value : values) {
+    value = engine() % 100000;
+  }
+  return values;
+}
+}  // namespace
+
+TEST(ParallelTest, SortMatchesStdSort) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+
+  for (auto size : {0, 1, 1000, 100000, 1000003}) {
+    auto values = randomValues(size);
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    Parallel::Sort(*executor, values.begin(), values.end());
+    ASSERT_EQ(values, expected);
+
+    Parallel::Sort(*executor, values.begin(), values.end(),
+                   std::greater<>());
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end(),
+                               std::greater<>()));
+  }
+}
+
+TEST(ParallelTest, SortMovesOnlyValues) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  std::vector<std::unique_ptr<int>> values;
+  for (auto value : randomValues(50000)) {
+    values.emplace_back(std::make_unique<int>(value));
+  }
+
+  Parallel::Sort(*executor, values.begin(), values.end(),
+                 [](const auto& a, const auto& b) { return *a < *b; });
+
+  ASSERT_TRUE(std::is_sorted(
+      values.begin(), values.end(),
+      [](const auto& a, const auto& b) { return *a < *b; }));
+}
+
+TEST(ParallelTest, ReduceCombinesInOrder) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  auto values = randomValues(1000003);
+
+  auto sum = Parallel::Reduce(*executor, values.begin(), values.end(),
+                              uint64_t(0));
+  ASSERT_EQ(sum, std::accumulate(values.begin(), values.end(), uint64_t(0)));
+
+  std::vector<std::string> words(20000);
+  for (auto i = std::size_t(0); i < words.size(); i++) {
+    words[i] = std::to_string(i % 10);
+  }
+  auto joined = Parallel::Reduce(*executor, words.begin(), words.end(),
+                                 std::string());
+  ASSERT_EQ(joined, std::accumulate(words.begin(), words.end(),
+                                    std::string()));
+
+  auto squares = Parallel::TransformReduce(
+      *executor, values.begin(), values.end(), uint64_t(0), std::plus<>(),
+      [](uint32_t value) { return uint64_t(value) * value; });
+  auto expected = uint64_t(0);
+  for (auto value : values) {
+    expected += uint64_t(value) * value;
+  }
+  ASSERT_EQ(squares, expected);
+}
+
+TEST(ParallelTest, InclusiveScanMatchesPartialSum) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+
+  for (auto size : {0, 1, 1000, 1000003}) {
+    auto values = randomValues(size);
+    std::vector<uint64_t> sums(values.begin(), values.end());
+    std::vector<uint64_t> expected(size);
+    std::partial_sum(sums.begin(), sums.end(), expected.begin());
+
+    Parallel::InclusiveScan(*executor, sums.begin(), sums.end(),
+                            sums.begin());
+    ASSERT_EQ(sums, expected);
+  }
+}
+
+TEST(ParallelTest, ForEachVisitsEveryElementAndRethrows) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  std::vector<int> values(100000, 1);
+
+  Parallel::ForEach(*executor, values.begin(), values.end(),
+                    [](int& value) { value *= 3; });
+  ASSERT_EQ(std::count(values.begin(), values.end(), 3), 100000);
+
+  auto failing = [&] {
+    Parallel::ForEach(*executor, values.begin(), values.end(), [](int&) {
+      throw std::runtime_error("failure");
+    });
+  };
+  ASSERT_THROW(failing(), std::runtime_error);
+}
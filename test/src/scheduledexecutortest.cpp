@@ -0,0 +1,176 @@
+#include <cpputils/countdownlatch.h>
+#include <cpputils/scheduledexecutor.h>
+#include <cpputils/threadpoolexecutor.h>
+#include <cpputils/timerwheel.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+TEST(ScheduledExecutorTest, TimerWheelExpiresInDeadlineOrder) {
+  TimerWheel wheel;
+  std::vector<TimerNode> nodes(5);
+  uint64_t deadlines[] = {70000, 3, 300, 255, 65536};
+
+  for (auto i = 0u; i < nodes.size(); i++) {
+    nodes[i].deadline = deadlines[i];
+    wheel.Insert(&nodes[i]);
+  }
+  wheel.Remove(&nodes[2]);
+
+  std::vector<TimerNode*> expired;
+  wheel.Advance(100000, expired);
+
+  ASSERT_EQ(wheel.Size(), 0u);
+  ASSERT_EQ(expired.size(), 4u);
+  ASSERT_EQ(expired[0]->deadline, 3u);
+  ASSERT_EQ(expired[1]->deadline, 255u);
+  ASSERT_EQ(expired[2]->deadline, 65536u);
+  ASSERT_EQ(expired[3]->deadline, 70000u);
+}
+
+TEST(ScheduledExecutorTest, TimerWheelFiresAtDeadline) {
+  TimerWheel wheel(1000);
+  TimerNode node;
+  node.deadline = 1000 + 20000;
+  wheel.Insert(&node);
+
+  std::vector<TimerNode*> expired;
+  wheel.Advance(1000 + 19999, expired);
+  ASSERT_TRUE(expired.empty());
+
+  wheel.Advance(1000 + 20000, expired);
+  ASSERT_EQ(expired.size(), 1u);
+}
+
+TEST(ScheduledExecutorTest, ScheduleRunsAfterDelay) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto scheduler = std::make_shared<ScheduledExecutor>(*executor);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(1);
+
+  auto start = std::chrono::steady_clock::now();
+  scheduler->Schedule(std::chrono::milliseconds(50),
+                      [latch] { latch->CountDown(); });
+  latch->Await();
+
+  ASSERT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(50));
+}
+
+TEST(ScheduledExecutorTest, CancelPreventsRun) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto scheduler = std::make_shared<ScheduledExecutor>(*executor);
+  auto called = std::make_shared<std::atomic<bool>>(false);
+
+  auto handle = scheduler->Schedule(std::chrono::milliseconds(50),
+                                    [called] { called->store(true); });
+
+  ASSERT_TRUE(handle.Cancel());
+  ASSERT_FALSE(handle.Cancel());
+  ASSERT_TRUE(handle.IsCancelled());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_FALSE(called->load());
+}
+
+TEST(ScheduledExecutorTest, FixedRateRepeatsUntilCancelled) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto scheduler = std::make_shared<ScheduledExecutor>(*executor);
+  auto latch = std::make_shared<Synchronization::CountDownLatch>(5);
+  auto counter = std::make_shared<std::atomic<int>>(0);
+
+  auto handle = scheduler->ScheduleAtFixedRate(
+      std::chrono::milliseconds(0), std::chrono::milliseconds(10),
+      [latch, counter] {
+        if (counter->fetch_add(1) < 5) {
+          latch->CountDown();
+        }
+      });
+
+  latch->Await();
+  ASSERT_TRUE(handle.Cancel());
+
+  auto runs = counter->load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_LE(counter->load(), runs + 1);
+}
+
+namespace {
+// Holds tasks until the test runs them, or refuses them outright.
+class ManualExecutor : public Executor {
+ public:
+  void Execute(Task&& task) override {
+    if (refuse.load()) {
+      throw std::runtime_error("refused");
+    }
+    auto lock = std::unique_lock<std::mutex>(mx);
+    tasks.emplace_back(std::move(task));
+  }
+
+  std::size_t RunAll() {
+    auto lock = std::unique_lock<std::mutex>(mx);
+    auto ready = std::move(tasks);
+    tasks.clear();
+    lock.unlock();
+
+    for (auto& task : ready) {
+      task();
+    }
+    return ready.size();
+  }
+
+  std::atomic<bool> refuse{false};
+
+ private:
+  std::mutex mx;
+  std::vector<Task> tasks;
+};
+}  // namespace
+
+TEST(ScheduledExecutorTest, CancelPreventsDispatchedRun) {
+  auto executor = ManualExecutor();
+  auto scheduler = std::make_shared<ScheduledExecutor>(executor);
+  auto called = std::make_shared<std::atomic<int>>(0);
+
+  auto handle = scheduler->Schedule(std::chrono::milliseconds(0),
+                                    [called] { called->fetch_add(1); });
+  ASSERT_TRUE(handle.Cancel());
+  ASSERT_EQ(executor.RunAll(), 1u);
+  ASSERT_EQ(called->load(), 0);
+
+  handle = scheduler->Schedule(std::chrono::milliseconds(0),
+                               [called] { called->fetch_add(1); });
+  ASSERT_EQ(executor.RunAll(), 1u);
+  ASSERT_EQ(called->load(), 1);
+  ASSERT_FALSE(handle.Cancel());
+}
+
+TEST(ScheduledExecutorTest, RefusedDispatchSkipsRun) {
+  auto executor = ManualExecutor();
+  auto scheduler = std::make_shared<ScheduledExecutor>(executor);
+  auto once = std::make_shared<std::atomic<int>>(0);
+  auto periodic = std::make_shared<std::atomic<int>>(0);
+
+  executor.refuse.store(true);
+  scheduler->Schedule(std::chrono::milliseconds(5),
+                      [once] { once->fetch_add(1); });
+  auto handle = scheduler->ScheduleAtFixedRate(
+      std::chrono::milliseconds(5), std::chrono::milliseconds(10),
+      [periodic] { periodic->fetch_add(1); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+  executor.refuse.store(false);
+  while (periodic->load() < 2) {
+    executor.RunAll();
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(handle.Cancel());
+  ASSERT_EQ(once->load(), 0);
+}
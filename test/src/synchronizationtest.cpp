@@ -0,0 +1,472 @@
+#include <cpputils/countdownlatch.h>
+#include <cpputils/cyclicbarrier.h>
+#include <cpputils/eventcount.h>
+#include <cpputils/phaser.h>
+#include <cpputils/profiledmutex.h>
+#include <cpputils/ratelimiter.h>
+#include <cpputils/semaphore.h>
+#include <cpputils/seqlock.h>
+#include <cpputils/shardedsharedmutex.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CppUtils;
+using namespace CppUtils::Synchronization;
+
+TEST(SynchronizationTest, EventCountWakesWaiters) {
+  auto events = std::make_shared<EventCount>();
+  auto available = std::make_shared<std::atomic<int>>(0);
+  auto consumed = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < 4; i++) {
+    consumers.emplace_back([events, available, consumed] {
+      for (int j = 0; j < 1000; j++) {
+        while (true) {
+          auto value = available->load();
+          if (value > 0 && available->compare_exchange_weak(value, value - 1)) {
+            break;
+          }
+          if (value > 0) {
+            continue;
+          }
+
+          auto key = events->PrepareWait();
+          if (available->load() > 0) {
+            events->CancelWait();
+          } else {
+            events->Wait(key);
+          }
+        }
+        consumed->fetch_add(1);
+      }
+    });
+  }
+
+  for (int i = 0; i < 4000; i++) {
+    available->fetch_add(1);
+    events->NotifyOne();
+    if (i % 100 == 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+
+  ASSERT_EQ(consumed->load(), 4000);
+  ASSERT_EQ(events->GetWaiterCount(), 0u);
+}
+
+TEST(SynchronizationTest, CountDownLatchWakesAllWaiters) {
+  auto latch = std::make_shared<CountDownLatch>(1000);
+  auto released = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < 4; i++) {
+    waiters.emplace_back([latch, released] {
+      latch->Await();
+      (*released)++;
+    });
+  }
+
+  std::vector<std::thread> counters;
+  for (int i = 0; i < 4; i++) {
+    counters.emplace_back([latch] {
+      for (int j = 0; j < 250; j++) {
+        latch->CountDown();
+      }
+    });
+  }
+  for (auto& counter : counters) {
+    counter.join();
+  }
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+
+  ASSERT_EQ(*released, 4);
+  ASSERT_TRUE(latch->TryAwait());
+
+  latch->CountDown();
+  ASSERT_TRUE(latch->TryAwait());
+}
+
+TEST(SynchronizationTest, CountDownLatchTimedWaitsAndReset) {
+  auto latch = CountDownLatch(2);
+
+  ASSERT_FALSE(latch.TryAwait());
+  ASSERT_FALSE(latch.AwaitFor(std::chrono::milliseconds(10)));
+  latch.CountDown();
+  ASSERT_FALSE(latch.AwaitUntil(std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds(10)));
+
+  auto counter = std::thread([&latch] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    latch.CountDown();
+  });
+  ASSERT_TRUE(latch.AwaitFor(std::chrono::seconds(10)));
+  counter.join();
+
+  latch.Reset();
+  ASSERT_FALSE(latch.TryAwait());
+  latch.CountDown();
+  latch.CountDown();
+  ASSERT_TRUE(latch.AwaitFor(std::chrono::milliseconds(0)));
+
+  ASSERT_TRUE(CountDownLatch(0).TryAwait());
+}
+
+TEST(SynchronizationTest, CyclicBarrierSynchronizesRounds) {
+  const int parties = 8;
+  const int rounds = 200;
+
+  auto completed = std::make_shared<std::atomic<int>>(0);
+  auto barrier = std::make_shared<CyclicBarrier>(
+      parties, [completed] { (*completed)++; });
+  auto counters = std::make_shared<std::vector<std::atomic<int>>>(rounds);
+  auto errors = std::make_shared<std::atomic<int>>(0);
+  auto trips = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < parties; i++) {
+    threads.emplace_back([=] {
+      for (int round = 0; round < rounds; round++) {
+        (*counters)[round]++;
+        if (barrier->Await()) {
+          (*trips)++;
+        }
+        // Every party of this round has arrived and the completion ran.
+        if ((*counters)[round] != parties || *completed < round + 1) {
+          (*errors)++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(*errors, 0);
+  ASSERT_EQ(*completed, rounds);
+  ASSERT_EQ(*trips, rounds);
+  ASSERT_EQ(barrier->GetGeneration(), static_cast<uint32_t>(rounds));
+}
+
+TEST(SynchronizationTest, CyclicBarrierReleasesWhenCompletionThrows) {
+  auto barrier = CyclicBarrier(2, [] { throw std::runtime_error("test"); });
+
+  auto other = std::thread([&barrier] {
+    try {
+      barrier.Await();
+    } catch (const std::runtime_error&) {
+    }
+  });
+  try {
+    barrier.Await();
+  } catch (const std::runtime_error&) {
+  }
+  other.join();
+
+  ASSERT_EQ(barrier.GetGeneration(), 1u);
+  ASSERT_THROW(CyclicBarrier(0), std::runtime_error);
+}
+
+TEST(SynchronizationTest, PhaserAdvancesWithDynamicParties) {
+  const int workers = 4;
+  const int rounds = 3;
+
+  // The main thread's party keeps phase 0 open until all workers registered.
+  auto phaser = std::make_shared<Phaser>(1);
+  auto counters =
+      std::make_shared<std::vector<std::atomic<int>>>(workers * rounds);
+  auto errors = std::make_shared<std::atomic<int>>(0);
+
+  // Worker i leaves after (i + 1) * rounds phases.
+  auto present = [=](int phase) {
+    auto count = 0;
+    for (int i = 0; i < workers; i++) {
+      count += phase < (i + 1) * rounds ? 1 : 0;
+    }
+    return count;
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < workers; i++) {
+    phaser->Register();
+    threads.emplace_back([=] {
+      for (int phase = 0; phase < (i + 1) * rounds; phase++) {
+        (*counters)[phase]++;
+        if (phase + 1 == (i + 1) * rounds) {
+          phaser->ArriveAndDeregister();
+          break;
+        }
+        auto next = phaser->ArriveAndAwaitAdvance();
+        if (next != static_cast<uint32_t>(phase + 1) ||
+            (*counters)[phase] != present(phase)) {
+          (*errors)++;
+        }
+      }
+    });
+  }
+  phaser->ArriveAndDeregister();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(*errors, 0);
+  ASSERT_EQ(phaser->GetPhase(), static_cast<uint32_t>(workers * rounds));
+  ASSERT_EQ(phaser->GetRegisteredParties(), 0u);
+  ASSERT_THROW(phaser->Arrive(), std::runtime_error);
+  ASSERT_EQ(phaser->GetRegisteredParties(), 0u);
+
+  auto phase = phaser->Register(2);
+  ASSERT_EQ(phaser->Arrive(), phase);
+  ASSERT_EQ(phaser->GetUnarrivedParties(), 1u);
+  ASSERT_EQ(phaser->Arrive(), phase);
+  ASSERT_EQ(phaser->AwaitAdvance(phase), phase + 1);
+  ASSERT_EQ(phaser->GetUnarrivedParties(), 2u);
+}
+
+TEST(SynchronizationTest, PhaserArrivalRacesAdvance) {
+  const auto phases = 20000u;
+  auto phaser = Phaser(2);
+  auto errors = std::atomic<int>(0);
+
+  // As soon as the other party has arrived, this one arrives for the next
+  // phase, possibly before the advance has been published.
+  auto eager = std::thread([&] {
+    for (auto i = 0u; i < phases; i++) {
+      try {
+        auto phase = phaser.Arrive();
+        while (phaser.GetPhase() == phase &&
+               phaser.GetUnarrivedParties() != 0) {
+          std::this_thread::yield();
+        }
+      } catch (const std::runtime_error&) {
+        errors++;
+      }
+    }
+  });
+  for (auto i = 0u; i < phases; i++) {
+    phaser.ArriveAndAwaitAdvance();
+  }
+  eager.join();
+
+  ASSERT_EQ(errors, 0);
+  ASSERT_EQ(phaser.GetPhase(), phases);
+}
+
+TEST(SynchronizationTest, SemaphoreBoundsConcurrency) {
+  auto semaphore = std::make_shared<Semaphore>(3);
+  auto active = std::make_shared<std::atomic<int>>(0);
+  auto peak = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([=] {
+      for (int j = 0; j < 200; j++) {
+        semaphore->Acquire();
+        auto now = ++(*active);
+        auto seen = peak->load();
+        while (now > seen && !peak->compare_exchange_weak(seen, now)) {
+        }
+        if (j % 16 == 0) {
+          std::this_thread::yield();
+        }
+        (*active)--;
+        semaphore->Release();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_LE(*peak, 3);
+  ASSERT_EQ(semaphore->GetAvailable(), 3u);
+}
+
+TEST(SynchronizationTest, SemaphoreTimedAcquire) {
+  auto semaphore = Semaphore(1);
+
+  ASSERT_TRUE(semaphore.TryAcquire());
+  ASSERT_FALSE(semaphore.TryAcquire());
+  ASSERT_FALSE(semaphore.TryAcquireFor(std::chrono::milliseconds(10)));
+
+  auto releaser = std::thread([&semaphore] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    semaphore.Release(2);
+  });
+  ASSERT_TRUE(semaphore.TryAcquireFor(std::chrono::seconds(10)));
+  releaser.join();
+
+  ASSERT_EQ(semaphore.GetAvailable(), 1u);
+}
+
+TEST(SynchronizationTest, RateLimiterAllowsBurstThenRefills) {
+  auto limiter = RateLimiter(20.0, 5);
+
+  ASSERT_FALSE(limiter.TryAcquire(6));
+  ASSERT_TRUE(limiter.TryAcquire(4));
+  ASSERT_TRUE(limiter.TryAcquire());
+  ASSERT_FALSE(limiter.TryAcquire());
+  ASSERT_EQ(limiter.GetAvailable(), 0u);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  ASSERT_GE(limiter.GetAvailable(), 2u);
+  ASSERT_TRUE(limiter.TryAcquire(2));
+
+  auto started = std::chrono::steady_clock::now();
+  limiter.Acquire(5);
+  ASSERT_GE(std::chrono::steady_clock::now() - started,
+            std::chrono::milliseconds(50));
+
+  ASSERT_THROW(RateLimiter(0.0), std::runtime_error);
+  ASSERT_THROW(RateLimiter(1.0, 0), std::runtime_error);
+}
+
+namespace {
+struct Snapshot {
+  uint64_t first;
+  uint64_t second;
+  uint32_t third;
+};
+}  // namespace
+
+TEST(SynchronizationTest, SeqLockReadsConsistentSnapshots) {
+  auto lock = std::make_shared<SeqLock<Snapshot>>(Snapshot{0, 0, 0});
+  auto running = std::make_shared<std::atomic<bool>>(true);
+  auto torn = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 3; i++) {
+    readers.emplace_back([=] {
+      while (*running) {
+        auto snapshot = lock->Load();
+        if (snapshot.second != snapshot.first * 2 ||
+            snapshot.third != static_cast<uint32_t>(snapshot.first)) {
+          (*torn)++;
+        }
+      }
+    });
+  }
+
+  for (uint64_t i = 1; i <= 20000; i++) {
+    if (i % 2 == 0) {
+      lock->Store(Snapshot{i, i * 2, static_cast<uint32_t>(i)});
+    } else {
+      lock->Update([](Snapshot snapshot) {
+        auto next = snapshot.first + 1;
+        return Snapshot{next, next * 2, static_cast<uint32_t>(next)};
+      });
+    }
+  }
+  *running = false;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  ASSERT_EQ(*torn, 0);
+  ASSERT_EQ(lock->Load().first, 20000u);
+  ASSERT_EQ(lock->GetVersion(), 20000u);
+}
+
+TEST(SynchronizationTest, ShardedSharedMutexExcludesWriters) {
+  auto mutex = std::make_shared<ShardedSharedMutex>(4);
+  auto first = std::make_shared<uint64_t>(0);
+  auto second = std::make_shared<uint64_t>(0);
+  auto errors = std::make_shared<std::atomic<int>>(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 6; i++) {
+    threads.emplace_back([=] {
+      for (int j = 0; j < 2000; j++) {
+        if (j % 10 == i % 10) {
+          auto lock = std::unique_lock<ShardedSharedMutex>(*mutex);
+          (*first)++;
+          std::this_thread::yield();
+          (*second)++;
+        } else {
+          auto lock = std::shared_lock<ShardedSharedMutex>(*mutex);
+          if (*first != *second) {
+            (*errors)++;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(*errors, 0);
+  ASSERT_EQ(*first, 6u * 200u);
+  ASSERT_EQ(*second, *first);
+
+  ASSERT_TRUE(mutex->try_lock_shared());
+  ASSERT_FALSE(mutex->try_lock());
+  mutex->unlock_shared();
+  ASSERT_TRUE(mutex->try_lock());
+  ASSERT_FALSE(mutex->try_lock_shared());
+  mutex->unlock();
+}
+
+TEST(SynchronizationTest, ProfiledMutexRecordsContention) {
+  auto& registry = LockRegistry::Get();
+  auto find = [&registry](const std::string& name) {
+    for (auto& profile : registry.Snapshot()) {
+      if (profile.name == name) {
+        return profile;
+      }
+    }
+    return LockProfile();
+  };
+
+  auto first = std::make_shared<ProfiledMutex>("SynchronizationTest::mx");
+  auto second = std::make_shared<ProfiledMutex>("SynchronizationTest::mx");
+  auto counter = std::make_shared<int>(0);
+
+  {
+    auto lock = std::unique_lock<ProfiledMutex>(*first);
+    auto waiter = std::thread([first, counter] {
+      auto lock = std::unique_lock<ProfiledMutex>(*first);
+      (*counter)++;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    lock.unlock();
+    waiter.join();
+  }
+  ASSERT_TRUE(second->try_lock());
+  second->unlock();
+
+  auto profile = find("SynchronizationTest::mx");
+  ASSERT_EQ(*counter, 1);
+  ASSERT_EQ(profile.instances, 2u);
+  ASSERT_EQ(profile.acquisitions, 3u);
+  ASSERT_EQ(profile.contended, 1u);
+  ASSERT_EQ(profile.waitTime.GetCount(), 1u);
+  ASSERT_GE(profile.waited, std::chrono::milliseconds(10));
+  ASSERT_GE(profile.held, std::chrono::milliseconds(10));
+  ASSERT_EQ(profile.worstWaits.size(), 1u);
+  ASSERT_EQ(profile.worstWaits[0].duration, profile.waited);
+  ASSERT_NE(registry.Report().find("SynchronizationTest::mx"),
+            std::string::npos);
+
+  registry.Reset();
+  profile = find("SynchronizationTest::mx");
+  ASSERT_EQ(profile.acquisitions, 0u);
+  ASSERT_EQ(profile.waitTime.GetCount(), 0u);
+  ASSERT_TRUE(profile.worstWaits.empty());
+}
@@ -0,0 +1,116 @@
+#include <cpputils/taskgraph.h>
+#include <cpputils/threadpoolexecutor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace CppUtils;
+using namespace CppUtils::Execution;
+
+TEST(TaskGraphTest, RunsNodesAfterTheirPredecessors) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(4);
+  auto graph = std::make_shared<TaskGraph>();
+  auto clock = std::make_shared<std::atomic<int>>(0);
+  auto finished = std::make_shared<std::vector<std::atomic<int>>>(6);
+
+  // 0 -> {1, 2, 3} -> 4 -> 5
+  for (auto i = 0; i < 6; i++) {
+    graph->AddNode([clock, finished, i] {
+      (*finished)[i].store(clock->fetch_add(1) + 1);
+    });
+  }
+  for (auto i = 1; i <= 3; i++) {
+    graph->AddEdge(0, i);
+    graph->AddEdge(i, 4);
+  }
+  graph->AddEdge(4, 5);
+
+  for (auto run = 0; run < 100; run++) {
+    graph->Run(*executor).Get();
+
+    auto& times = *finished;
+    for (auto i = 1; i <= 3; i++) {
+      ASSERT_LT(times[0].load(), times[i].load());
+      ASSERT_LT(times[i].load(), times[4].load());
+    }
+    ASSERT_LT(times[4].load(), times[5].load());
+  }
+  ASSERT_EQ(clock->load(), 600);
+}
+
+TEST(TaskGraphTest, RejectsCyclesAndInvalidEdges) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto graph = std::make_shared<TaskGraph>();
+
+  auto a = graph->AddNode([] {});
+  auto b = graph->AddNode([] {});
+  graph->AddEdge(a, b);
+  graph->AddEdge(b, a);
+
+  ASSERT_THROW(graph->AddEdge(a, a), std::runtime_error);
+  ASSERT_THROW(graph->AddEdge(a, 5), std::runtime_error);
+  ASSERT_THROW(graph->Run(*executor), std::runtime_error);
+}
+
+TEST(TaskGraphTest, ExceptionSkipsRemainingNodes) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto graph = std::make_shared<TaskGraph>();
+  auto ran = std::make_shared<std::atomic<bool>>(false);
+
+  auto hash = graph->AddNode([] { throw std::runtime_error("failure"); });
+  auto write = graph->AddNode([ran] { ran->store(true); });
+  graph->AddEdge(hash, write);
+
+  ASSERT_THROW(graph->Run(*executor).Get(), std::runtime_error);
+  ASSERT_FALSE(ran->load());
+
+  auto rerun = graph->Run(*executor).Then([] { return 1; });
+  ASSERT_THROW(rerun.Get(), std::runtime_error);
+}
+
+namespace {
+// Forwards the first accepted tasks to a pool and refuses the rest.
+class LimitedExecutor : public Executor {
+ public:
+  LimitedExecutor(Executor& target, int accepted)
+      : target(target), accepted(accepted) {}
+
+  void Execute(Task&& task) override {
+    if (accepted.fetch_sub(1) <= 0) {
+      throw std::runtime_error("refused");
+    }
+    target.Execute(std::move(task));
+  }
+
+ private:
+  Executor& target;
+  std::atomic<int> accepted;
+};
+}  // namespace
+
+TEST(TaskGraphTest, RefusedDispatchFailsRun) {
+  auto executor = std::make_shared<ThreadPoolExecutor>(2);
+  auto graph = std::make_shared<TaskGraph>();
+  auto runs = std::make_shared<std::atomic<int>>(0);
+
+  // Two roots fanning out, so both Run and runNode have to dispatch.
+  auto left = graph->AddNode([runs] { runs->fetch_add(1); });
+  auto right = graph->AddNode([runs] { runs->fetch_add(1); });
+  for (int i = 0; i < 4; i++) {
+    auto node = graph->AddNode([runs] { runs->fetch_add(1); });
+    graph->AddEdge(left, node);
+    graph->AddEdge(right, node);
+  }
+
+  for (auto accepted : {0, 1, 2}) {
+    auto limited = LimitedExecutor(*executor, accepted);
+    ASSERT_THROW(graph->Run(limited).Get(), std::runtime_error);
+  }
+
+  runs->store(0);
+  graph->Run(*executor).Get();
+  ASSERT_EQ(runs->load(), 6);
+}